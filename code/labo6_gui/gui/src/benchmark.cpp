@@ -0,0 +1,210 @@
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QStringList>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "guiinterface.h"
+
+/**
+ * Banc d'essai de la vue de simulation, sans affichage (plateforme Qt offscreen).
+ *
+ * Des flux d'événements synthétiques (requêtes, exécutions des moteurs, résultats) sont envoyés à GuiInterface depuis
+ * des threads, comme le font les moteurs de calcul, à un débit donné. Sont mesurés : le débit d'événements absorbés
+ * par la vue, le temps de rendu d'une image, le nombre d'éléments de la scène et la mémoire du processus.
+ *
+ * Sans argument, chaque configuration (débit, nombre de moteurs) est mesurée dans un processus séparé et le tableau
+ * des résultats est affiché au format CSV. Avec --rate et --engines, une seule configuration est mesurée.
+ */
+
+namespace {
+
+struct Configuration {
+    // The number of events per second sent by all the engines together
+    long long rate = 10000;
+    int engines = 4;
+    double duration = 2.0;
+};
+
+// The interval between two frames while the events are ingested (60 images per second)
+constexpr int FRAME_INTERVAL_MS = 16;
+// The number of execution slices of a synthetic computation
+constexpr int SLICES_PER_COMPUTATION = 4;
+
+long long residentKiloBytes()
+{
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return std::stoll(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+/**
+ * Sends the events of a compute engine at a given rate : a computation is a request, its start, a few execution
+ * slices, its end and its result
+ */
+void produce(int engine, long long rate, double duration, std::atomic<long long>& sent)
+{
+    GuiInterface* gui = GuiInterface::instance;
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(duration));
+    auto interval = std::chrono::nanoseconds(1000000000LL / std::max(1LL, rate));
+    auto next = start;
+    long long events = 0;
+    int computation = 0;
+    while (next < end) {
+        quint64 id = engine * 1000000ULL + computation++;
+        long long t = gui->getCurrentTime();
+        gui->addRequestStart(id, t);
+        gui->addTaskStart(engine, t);
+        long long last = t;
+        for (int slice = 0; slice < SLICES_PER_COMPUTATION; ++slice) {
+            long long now = gui->getCurrentTime();
+            gui->addTaskExecute(engine, last, now);
+            last = now;
+        }
+        gui->addTaskEnd(engine, last);
+        gui->addResult(last, QString("%1").arg(id));
+        events += 4 + SLICES_PER_COMPUTATION;
+        next += interval * (4 + SLICES_PER_COMPUTATION);
+        std::this_thread::sleep_until(next);
+    }
+    sent += events;
+}
+
+int runConfiguration(const Configuration& configuration, int argc, char* argv[])
+{
+    QApplication app(argc, argv);
+    GuiInterface::initialize(argc, argv, false);
+    GuiInterface* gui = GuiInterface::instance;
+    SimView* view = gui->getWindow()->simView;
+    for (int engine = 0; engine < configuration.engines; ++engine) {
+        gui->registerComputeEngine(engine, QString("Engine %1").arg(engine));
+    }
+    QCoreApplication::processEvents();
+    long long memoryBefore = residentKiloBytes();
+
+    std::atomic<long long> sent{0};
+    std::atomic<int> running{configuration.engines};
+    std::vector<std::thread> producers;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    for (int engine = 0; engine < configuration.engines; ++engine) {
+        producers.emplace_back([&, engine]() {
+            produce(engine, configuration.rate / configuration.engines, configuration.duration, sent);
+            --running;
+        });
+    }
+
+    // The events are delivered by the event loop, a frame is rendered regularly like on screen
+    std::vector<double> frameTimes;
+    QElapsedTimer sinceFrame;
+    sinceFrame.start();
+    while (running > 0) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, FRAME_INTERVAL_MS);
+        if (sinceFrame.elapsed() >= FRAME_INTERVAL_MS) {
+            QElapsedTimer frame;
+            frame.start();
+            view->viewport()->grab();
+            frameTimes.push_back(frame.nsecsElapsed() / 1e6);
+            sinceFrame.restart();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    // Everything sent has been ingested once the event posted last is delivered
+    bool drained = false;
+    QMetaObject::invokeMethod(view, [&drained]() { drained = true; }, Qt::QueuedConnection);
+    while (!drained) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+    }
+    double seconds = elapsed.nsecsElapsed() / 1e9;
+
+    // And a last frame of the whole timeline
+    QElapsedTimer frame;
+    frame.start();
+    view->zoomFit();
+    view->viewport()->grab();
+    double fullFrame = frame.nsecsElapsed() / 1e6;
+
+    double meanFrame = 0.0;
+    double maxFrame = 0.0;
+    for (double time : frameTimes) {
+        meanFrame += time;
+        maxFrame = std::max(maxFrame, time);
+    }
+    meanFrame = frameTimes.empty() ? 0.0 : meanFrame / frameTimes.size();
+
+    std::cout << configuration.engines << ',' << configuration.rate << ',' << sent << ',' << sent / seconds << ','
+              << meanFrame << ',' << maxFrame << ',' << fullFrame << ',' << view->scene()->items().size() << ','
+              << residentKiloBytes() - memoryBefore << std::endl;
+    return 0;
+}
+
+void printHeader()
+{
+    std::cout << "engines,rate,events,ingested_per_s,frame_ms_mean,frame_ms_max,full_frame_ms,scene_items,memory_kb"
+              << std::endl;
+}
+
+}
+
+/**
+ * Programme du banc d'essai
+ */
+int main(int argc, char *argv[])
+{
+    // Aucune fenêtre n'est affichée
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    Configuration configuration;
+    bool single = false;
+    bool header = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--rate" && i + 1 < argc) {
+            configuration.rate = std::stoll(argv[++i]);
+            single = true;
+        } else if (argument == "--engines" && i + 1 < argc) {
+            configuration.engines = std::max(1, std::stoi(argv[++i]));
+            single = true;
+        } else if (argument == "--duration" && i + 1 < argc) {
+            configuration.duration = std::stod(argv[++i]);
+        } else if (argument == "--no-header") {
+            header = false;
+        }
+    }
+    if (single) {
+        if (header) {
+            printHeader();
+        }
+        return runConfiguration(configuration, argc, argv);
+    }
+
+    // Every configuration is measured in its own process, so that the scene and the memory start empty
+    printHeader();
+    for (int engines : {1, 4, 16}) {
+        for (long long rate : {1000LL, 10000LL, 100000LL}) {
+            QProcess run;
+            run.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            run.start(argv[0], QStringList() << "--rate" << QString::number(rate) << "--engines"
+                                             << QString::number(engines) << "--duration"
+                                             << QString::number(configuration.duration) << "--no-header");
+            run.waitForFinished(-1);
+            std::cout << run.readAllStandardOutput().toStdString() << std::flush;
+        }
+    }
+    return 0;
+}
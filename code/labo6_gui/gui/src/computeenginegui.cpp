@@ -7,6 +7,7 @@ ComputeEngineGUI::ComputeEngineGUI(std::unique_ptr<ComputeEngineCommon> ce) : Ab
     myName = "Compute Engine " + nameFromType(myType()) + "-" + std::to_string(computeEngine->id);
     //std::cout << myName << " will register" << std::endl;
     GuiInterface::instance->registerComputeEngine(guiId, myName.c_str());
+    GuiInterface::instance->registerLogSource(guiId, myName.c_str(), nameFromType(myType()).c_str());
 }
 
 void ComputeEngineGUI::startComputation(const Request& r) {
@@ -14,6 +15,7 @@ void ComputeEngineGUI::startComputation(const Request& r) {
     auto t = GuiInterface::instance->getCurrentTime();
     //qDebug() << "time :" << t;
     GuiInterface::instance->addTaskStart(guiId, t);
+    GuiInterface::instance->logMessage(guiId, QString("Starts request %1").arg(r.getId()));
     computeEngine->startComputation(r);
     lastTime = t;
     started = true;
@@ -35,6 +37,7 @@ void ComputeEngineGUI::stopComputation() {
         //qDebug() << "time :" << t;
         GuiInterface::instance->addTaskExecute(guiId, lastTime, t);
         GuiInterface::instance->addTaskEnd(guiId, t);
+        GuiInterface::instance->logMessage(guiId, QString("Ends request %1").arg(computeEngine->currentRequest.getId()));
         computeEngine->stopComputation();
         started = false;
     }
@@ -2,6 +2,7 @@
 #define COMPUTEENGINEGUI_H
 
 #include "computeengine.h"
+#include "kernelregistry.h"
 
 // Decorator
 /* Note : This decorator only redefines methods used by run() and not by the wrapped compute engine
@@ -18,7 +19,8 @@ protected:
     void advanceComputation() override;
     bool isComputationDone() const override {return computeEngine->isComputationDone();}
     double getResult() const override {return computeEngine->result;}
-    int getCurrentRequestId() const override {return computeEngine->currentRequest.getId();}
+    std::shared_ptr<const std::vector<double>> getValues() const override {return computeEngine->values;}
+    RequestId getCurrentRequestId() const override {return computeEngine->currentRequest.getId();}
     void stopComputation() override;
 
     // Behavior function
@@ -35,7 +37,13 @@ private:
         case ComputationType::A : return std::string("A");
         case ComputationType::B : return std::string("B");
         case ComputationType::C : return std::string("C");
-        default: return std::string("?");
+        case ComputationType::D : return std::string("D");
+        case ComputationType::E : return std::string("E");
+        default:
+            if (auto kernel = KernelRegistry::instance().find(ct)) {
+                return std::string(kernel->typeName);
+            }
+            return std::string("?");
         }
     }
 
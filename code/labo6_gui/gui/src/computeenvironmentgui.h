@@ -13,15 +13,24 @@ public:
         for (unsigned i = 0; i < quantity; ++i) {
             switch(type) {
             case ComputationType::A :
-                threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEngineA>(computationManager)));
+                threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEngineA>(engineSource)));
                 break;
             case ComputationType::B :
-                 threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEngineB>(computationManager)));
+                 threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEngineB>(engineSource)));
                 break;
             case ComputationType::C :
-                 threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEngineC>(computationManager)));
+                 threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEngineC>(engineSource)));
+                break;
+            case ComputationType::D :
+                 threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEngineD>(engineSource)));
+                break;
+            case ComputationType::E :
+                 threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEngineE>(engineSource)));
                 break;
             default:
+                if (auto kernel = KernelRegistry::instance().find(type)) {
+                    threads.push_back(std::make_shared<ComputeEngineGUI>(std::make_unique<ComputeEnginePlugin>(engineSource, type, kernel)));
+                }
                 break;
             }
         }
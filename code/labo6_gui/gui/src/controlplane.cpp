@@ -0,0 +1,77 @@
+#include "controlplane.h"
+
+ControlPlane::ControlPlane(std::shared_ptr<ComputationManager> computationManager, QObject *parent)
+    : QObject(parent), computationManager(std::move(computationManager))
+{
+    control.thread = std::thread([this]() { run(control); });
+    submissions.thread = std::thread([this]() { run(submissions); });
+}
+
+ControlPlane::~ControlPlane()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finishing = true;
+    }
+    posted.notify_all();
+    // A submission blocked on a full queue is released
+    computationManager->stop();
+    control.thread.join();
+    submissions.thread.join();
+}
+
+void ControlPlane::submit(Computation c, long long time)
+{
+    post(submissions, [this, c, time]() {
+        try {
+            emit submitted(computationManager->requestComputation(c), time);
+        } catch (std::exception& e) {
+            emit submitFailed(time);
+        }
+    });
+}
+
+void ControlPlane::abort(RequestId id)
+{
+    post(control, [this, id]() {
+        computationManager->abortComputation(id);
+        emit aborted(id);
+    });
+}
+
+void ControlPlane::stop(std::function<void()> shutdown)
+{
+    post(control, [this, shutdown]() {
+        computationManager->stop();
+        if (shutdown) {
+            shutdown();
+        }
+        emit stopped();
+    });
+}
+
+void ControlPlane::post(Lane &lane, std::function<void()> command)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lane.commands.push_back(std::move(command));
+    }
+    posted.notify_all();
+}
+
+void ControlPlane::run(Lane &lane)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        posted.wait(lock, [&]() { return finishing || !lane.commands.empty(); });
+        if (finishing) {
+            return;
+        }
+        auto command = std::move(lane.commands.front());
+        lane.commands.pop_front();
+        // The manager is called without the lock, the GUI thread can post meanwhile
+        lock.unlock();
+        command();
+        lock.lock();
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef CONTROLPLANE_H
+#define CONTROLPLANE_H
+
+#include <QObject>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "computationmanager.h"
+
+/**
+ * @brief The ControlPlane class executes the operations asked by the GUI (submit, abort, stop) on its own threads,
+ * so that the GUI thread never enters the monitor of the computation manager. Posting an operation only takes a
+ * short lock on the command queue, its completion is reported by a signal.
+ *
+ * The submissions have their own thread : a submission blocked on a full queue does not delay the aborts that
+ * free the queue.
+ */
+class ControlPlane : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ControlPlane(std::shared_ptr<ComputationManager> computationManager, QObject *parent = nullptr);
+    ~ControlPlane();
+
+    /**
+     * @brief submit Posts a computation request, submitted is emitted once the manager has accepted it
+     * @param time the time of the click, given back with the id
+     */
+    void submit(Computation c, long long time);
+
+    /**
+     * @brief abort Posts the abort of a request, aborted is emitted once it is done
+     */
+    void abort(RequestId id);
+
+    /**
+     * @brief stop Posts the stop of the manager, then calls shutdown (joining the compute engines for example) on
+     * the control thread and emits stopped
+     */
+    void stop(std::function<void()> shutdown = nullptr);
+
+signals:
+    void submitted(quint64 id, long long time);
+    void submitFailed(long long time);
+    void aborted(quint64 id);
+    void stopped();
+
+private:
+    struct Lane {
+        std::deque<std::function<void()>> commands;
+        std::thread thread;
+    };
+
+    void post(Lane &lane, std::function<void()> command);
+    void run(Lane &lane);
+
+    std::shared_ptr<ComputationManager> computationManager;
+    std::mutex mutex;
+    std::condition_variable posted;
+    bool finishing{false};
+    // The aborts and the stop
+    Lane control;
+    // The requests, in the order of the clicks
+    Lane submissions;
+};
+
+#endif // CONTROLPLANE_H
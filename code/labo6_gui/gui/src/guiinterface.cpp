@@ -19,7 +19,7 @@ GuiInterface::GuiInterface()
     window->show();
     CONNECT(this,SIGNAL(sig_addThreadTrigger(int,long long)),window->simView,SLOT(addThreadTrigger(int,long long)));
     CONNECT(this,SIGNAL(sid_addComputeRequest(long long, QString)), window->simView, SLOT(addComputeRequest(long long, QString)));
-    CONNECT(this,SIGNAL(sig_addRequestStart(int, long long)), window->simView,SLOT(addRequestStart(int, long long)));
+    CONNECT(this,SIGNAL(sig_addRequestStart(quint64, long long)), window->simView,SLOT(addRequestStart(quint64, long long)));
     CONNECT(this,SIGNAL(sig_addResult(long long, QString)), window->simView, SLOT(addResult(long long, QString)));
     CONNECT(this,SIGNAL(sig_addTaskStart(int,long long)),window->simView,SLOT(addTaskStart(int,long long)));
     CONNECT(this,SIGNAL(sig_addTaskEnd(int,long long)),window->simView,SLOT(addTaskEnd(int,long long)));
@@ -28,18 +28,21 @@ GuiInterface::GuiInterface()
     CONNECT(this,SIGNAL(sig_logMessage(int,QString)),window,SLOT(logMessage(int,QString)));
     CONNECT(this,SIGNAL(sig_addPeriodicTask(int,char *,long long,long long,long long)),window->simView,SLOT(addPeriodicTask(int,char *,long long,long long,long long)));
     CONNECT(this,SIGNAL(sig_registerComputeEngine(int, const QString)),window->simView,SLOT(registerComputeEngine(int, const QString)));
+    CONNECT(this,SIGNAL(sig_registerLogSource(int, const QString, const QString)),window,SLOT(registerLogSource(int, const QString, const QString)));
     CONNECT(this,SIGNAL(sig_setNbTasks(int)),window->simView,SLOT(setNbTasks(int)));
     CONNECT(this,SIGNAL(sig_logSpecial(int,int,char*,long long,long long)),window->simView,SLOT(logSpecial(int,int,char*,long long,long long)));
     timeBase = std::chrono::steady_clock::now();
 }
 
-void GuiInterface::initialize(int argc, char *argv[])
+void GuiInterface::initialize(int argc, char *argv[], bool startTasks)
 {
     if (instance==0)
         instance=new GuiInterface();
     instance->window->argc=argc;
     instance->window->argv=argv;
-	instance->window->startTasks();
+    // The benchmark feeds the view itself, without the compute engines
+    if (startTasks)
+        instance->window->startTasks();
 }
 
 GuiInterface* GuiInterface::getInstance()
@@ -64,7 +67,7 @@ void GuiInterface::addTask(int threadId, long long starttime, long long endtime)
     emit sig_addTask(threadId,starttime,endtime);
 }
 
-void GuiInterface::addRequestStart(int id, long long time)
+void GuiInterface::addRequestStart(quint64 id, long long time)
 {
     emit sig_addRequestStart(id, time);
 }
@@ -114,6 +117,11 @@ void GuiInterface::registerComputeEngine(int threadId, const QString name)
     emit sig_registerComputeEngine(threadId, name);
 }
 
+void GuiInterface::registerLogSource(int threadId, const QString name, const QString type)
+{
+    emit sig_registerLogSource(threadId, name, type);
+}
+
 void GuiInterface::flush()
 {
     QGraphicsView *view = window->simView;
@@ -16,7 +16,7 @@ public:
     void addThreadTrigger(int threadId,long long time);
     void addTask(int threadId,long long starttime,long long endtime);
     void addComputeRequest(long long time, QString text);
-    void addRequestStart(int id, long long time);
+    void addRequestStart(quint64 id, long long time);
     void addTaskStart(int threadId,long long time);
     void addResult(long long time, QString text);
     void addTaskEnd(int threadId,long long time);
@@ -26,8 +26,10 @@ public:
     void logSpecial(int threadId,int what,char *message,long long curTime,long long value);
     void setNbTasks(int nbTasks);
     void registerComputeEngine(int threadId, const QString name);
+    void registerLogSource(int threadId, const QString name, const QString type);
     void flush();
     void ending();
+    MainWindow *getWindow() {return window;}
     std::chrono::time_point<std::chrono::steady_clock> getTimeBase() {return timeBase;}
     long long getCurrentTime() {
         auto now = std::chrono::steady_clock::now();
@@ -35,7 +37,7 @@ public:
         return (long long)diff.count();
     }
 
-    static void initialize(int argc,char *argv[]);
+    static void initialize(int argc,char *argv[],bool startTasks = true);
     static GuiInterface *instance;
     static GuiInterface* getInstance();
 
@@ -43,7 +45,7 @@ signals:
     void sig_addThreadTrigger(int threadId,long long time);
     void sig_addTask(int threadId,long long starttime,long long endtime);
     void sid_addComputeRequest(long long time, QString text);
-    void sig_addRequestStart(int id, long long time);
+    void sig_addRequestStart(quint64 id, long long time);
     void sig_addResult(long long time, QString text);
     void sig_addTaskStart(int threadId,long long time);
     void sig_addTaskEnd(int threadId,long long time);
@@ -52,6 +54,7 @@ signals:
     void sig_logMessage(int threadId,QString message);
     void sig_addPeriodicTask(int threadId,char *taskName,long long idate,long long period,long long deadline);
     void sig_registerComputeEngine(int threadId, const QString name);
+    void sig_registerLogSource(int threadId, const QString name, const QString type);
     void sig_setNbTasks(int nbTasks);
 };
 
@@ -0,0 +1,107 @@
+#include "logmodel.h"
+
+#include <algorithm>
+
+LogModel::LogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent), capacity(std::max(1, capacity)), entries(this->capacity)
+{
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(FLUSH_INTERVAL_MS);
+    connect(&flushTimer, &QTimer::timeout, this, &LogModel::flush);
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : count;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= count) {
+        return QVariant();
+    }
+    const Entry &e = entry(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        if (e.source == GENERAL_SOURCE) {
+            return e.text;
+        }
+        return QString("[%1] %2").arg(sourceName(e.source), e.text);
+    case SourceRole:
+        return e.source;
+    case TypeRole: {
+        auto type = types.find(e.source);
+        return type == types.end() ? QString() : type->second;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+void LogModel::registerSource(int source, const QString &name, const QString &type)
+{
+    names[source] = name;
+    types[source] = type;
+}
+
+QString LogModel::sourceName(int source) const
+{
+    auto name = names.find(source);
+    return name == names.end() ? QString::number(source) : name->second;
+}
+
+void LogModel::append(int source, const QString &text)
+{
+    pending.push_back({source, text});
+    // A batch never holds more than the buffer
+    if (pending.size() >= static_cast<size_t>(capacity)) {
+        flush();
+    } else if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+}
+
+void LogModel::flush()
+{
+    flushTimer.stop();
+    if (pending.empty()) {
+        return;
+    }
+    int incoming = static_cast<int>(pending.size());
+    // The oldest messages leave the buffer to make room for the batch, in a single removal
+    int evicted = std::max(0, count + incoming - capacity);
+    if (evicted > 0) {
+        beginRemoveRows(QModelIndex(), 0, evicted - 1);
+        first = (first + evicted) % capacity;
+        count -= evicted;
+        endRemoveRows();
+    }
+    beginInsertRows(QModelIndex(), count, count + incoming - 1);
+    for (auto &e : pending) {
+        entries[(first + count) % capacity] = std::move(e);
+        ++count;
+    }
+    endInsertRows();
+    pending.clear();
+}
+
+void LogFilterModel::setSourceFilter(const QVariant &source)
+{
+    this->source = source;
+    invalidateFilter();
+}
+
+void LogFilterModel::setTypeFilter(const QString &type)
+{
+    this->type = type;
+    invalidateFilter();
+}
+
+bool LogFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+    if (source.isValid() && index.data(LogModel::SourceRole) != source) {
+        return false;
+    }
+    return type.isEmpty() || index.data(LogModel::TypeRole).toString() == type;
+}
@@ -0,0 +1,105 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include <QTimer>
+
+#include <map>
+#include <vector>
+
+/**
+ * @brief The LogModel class keeps the last messages of the console in a ring buffer of fixed capacity : once it is
+ * full, every new message replaces the oldest one. The messages are appended in batches, once per frame, so that a
+ * burst of messages costs a single update of the view.
+ */
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    // The number of messages kept
+    static constexpr int DEFAULT_CAPACITY = 10000;
+    // The interval between two batches (60 per second)
+    static constexpr int FLUSH_INTERVAL_MS = 16;
+    // The source of the messages that do not come from a compute engine
+    static constexpr int GENERAL_SOURCE = -1;
+
+    enum Roles {
+        SourceRole = Qt::UserRole,
+        TypeRole
+    };
+
+    explicit LogModel(int capacity = DEFAULT_CAPACITY, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief registerSource Names a source of messages (a compute engine) and gives the type it computes
+     */
+    void registerSource(int source, const QString &name, const QString &type);
+
+    /**
+     * @brief sourceName Returns the name of a source, its number if it was not registered
+     */
+    QString sourceName(int source) const;
+
+public slots:
+    /**
+     * @brief append Adds a message, it is shown with the next batch
+     */
+    void append(int source, const QString &text);
+
+    /**
+     * @brief flush Shows the messages waiting for the next batch
+     */
+    void flush();
+
+private:
+    struct Entry {
+        int source{GENERAL_SOURCE};
+        QString text;
+    };
+
+    const Entry &entry(int row) const { return entries[(first + row) % capacity]; }
+
+    const int capacity;
+    // The ring buffer : the oldest message is at first, there are count of them
+    std::vector<Entry> entries;
+    int first{0};
+    int count{0};
+    std::vector<Entry> pending;
+    std::map<int, QString> names;
+    std::map<int, QString> types;
+    QTimer flushTimer;
+};
+
+/**
+ * @brief The LogFilterModel class shows the messages of a source or of the sources of a type only
+ */
+class LogFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit LogFilterModel(QObject *parent = nullptr) : QSortFilterProxyModel(parent) {}
+
+public slots:
+    /**
+     * @brief setSourceFilter Shows the messages of a source only (an invalid QVariant : every source)
+     */
+    void setSourceFilter(const QVariant &source);
+
+    /**
+     * @brief setTypeFilter Shows the messages of the sources of a type only (empty : every type)
+     */
+    void setTypeFilter(const QString &type);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QVariant source;
+    QString type;
+};
+
+#endif // LOGMODEL_H
@@ -1,7 +1,10 @@
-#include <sys/mman.h>
 #include <QApplication>
+#include <QDebug>
 
 #include "guiinterface.h"
+#include "kernelcalibration.h"
+#include "kernelregistry.h"
+#include "memoryresidency.h"
 
 
 /**
@@ -9,11 +12,23 @@
  */
 int main(int argc, char *argv[])
 {
-    /* Avoids memory swapping for this program */
-    mlockall(MCL_CURRENT|MCL_FUTURE);
+    /* Avoids memory swapping for the hot structures of this program (LABO6_MEMORY_RESIDENCY=all locks everything) */
+    if (!MemoryResidency::apply(MemoryResidency::policyFromEnvironment())) {
+        qWarning() << "Cannot lock the memory of the program";
+    }
 
     QApplication app(argc,argv);
 
+    // Les noyaux utilisent la configuration mesurée pour cette machine (calibrée au premier démarrage)
+    KernelCalibration::ensureCalibrated();
+
+    // Les greffons de calcul doivent être chargés avant de peupler l'environnement
+    try {
+        KernelRegistry::instance().loadFromEnvironment();
+    } catch (KernelRegistry::PluginException& e) {
+        qWarning() << e.what();
+    }
+
     // Création de l'interface graphique.
     // C'est elle qui lance ensuite les tâches temps réel
     GuiInterface::initialize(argc,argv);
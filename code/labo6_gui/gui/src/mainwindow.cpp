@@ -1,6 +1,7 @@
 
 #include "mainwindow.h"
 #include "guiinterface.h"
+#include "kernelregistry.h"
 
 #include <QAction>
 #include <QMenuBar>
@@ -11,14 +12,55 @@
 #include <QCoreApplication>
 #include <QDockWidget>
 #include <QCloseEvent>
+#include <QHBoxLayout>
+#include <QScrollBar>
+#include <QVBoxLayout>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent)
 {
 
-    generalConsole = new QTextEdit(this);
+    // The console keeps a bounded number of messages, appended once per frame
+    logModel = new LogModel(LogModel::DEFAULT_CAPACITY, this);
+    logFilter = new LogFilterModel(this);
+    logFilter->setSourceModel(logModel);
+    generalConsole = new QListView();
+    generalConsole->setModel(logFilter);
+    generalConsole->setUniformItemSizes(true);
+    generalConsole->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    connect(generalConsole->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        followLog = value == generalConsole->verticalScrollBar()->maximum();
+    });
+    connect(logFilter, &QAbstractItemModel::rowsInserted, this, [this]() {
+        if (followLog) {
+            generalConsole->scrollToBottom();
+        }
+    });
+
+    sourceFilter = new QComboBox();
+    sourceFilter->addItem("Toutes les sources", QVariant());
+    sourceFilter->addItem("General", LogModel::GENERAL_SOURCE);
+    connect(sourceFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        logFilter->setSourceFilter(sourceFilter->itemData(index));
+    });
+    typeFilter = new QComboBox();
+    typeFilter->addItem("Tous les types", QString());
+    connect(typeFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        logFilter->setTypeFilter(typeFilter->itemData(index).toString());
+    });
+
+    QWidget *console = new QWidget(this);
+    QHBoxLayout *filters = new QHBoxLayout();
+    filters->addWidget(sourceFilter);
+    filters->addWidget(typeFilter);
+    filters->addStretch();
+    QVBoxLayout *consoleLayout = new QVBoxLayout(console);
+    consoleLayout->setContentsMargins(0, 0, 0, 0);
+    consoleLayout->addLayout(filters);
+    consoleLayout->addWidget(generalConsole);
+
     dockGeneralConsole = new QDockWidget("Console generale",this);
-    dockGeneralConsole->setWidget(generalConsole);
+    dockGeneralConsole->setWidget(console);
     addDockWidget(Qt::BottomDockWidgetArea,dockGeneralConsole,Qt::Horizontal);
 
     setGeometry(50,50,530,580);
@@ -27,8 +69,20 @@ MainWindow::MainWindow(QWidget *parent) :
 
     // Create the computation manager (shared buffer)
     computationManager = std::make_shared<ComputationManager>();
+    // The requests that block the delivery are reported in the console
+    computationManager->setHeadOfLineReporter(std::chrono::seconds(10), [](const std::string& report) {
+        GuiInterface::instance->logMessage(-1, QString::fromStdString(report));
+    });
+
+    // The GUI thread does not call the manager itself, its operations go through the control plane
+    controlPlane = new ControlPlane(computationManager, this);
+
+    simView = new SimView(controlPlane, this);
 
-    simView = new SimView(computationManager, this);
+    CONNECT(controlPlane, SIGNAL(submitted(quint64,long long)), simView, SLOT(addRequestStart(quint64,long long)));
+    CONNECT(controlPlane, SIGNAL(submitFailed(long long)), this, SLOT(submissionFailed(long long)));
+    CONNECT(controlPlane, SIGNAL(aborted(quint64)), this, SLOT(computationAborted(quint64)));
+    CONNECT(controlPlane, SIGNAL(stopped()), this, SLOT(tasksStopped()));
 
     setCentralWidget(simView);
 
@@ -96,33 +150,48 @@ void MainWindow::stopTasks()
 
     if (!called) {
         called = true;
-        try {
-            std::thread([&](){
-                GuiInterface::instance->logMessage(-1, "Stop pushed");
-                // Stop the manager
-                try {
-                    computationManager->stop();
-                } catch (ComputationManager::StopException& e) {
-                    GuiInterface::instance->logMessage(-1, "Monitor threw exception (already stopped ?)");
-                }
-
-                // Wait for the computation environment to shut down
+        GuiInterface::instance->logMessage(-1, "Stop pushed");
+        // The manager is stopped, then the computation environment is waited for on the control thread
+        auto environment = computeEnv;
+        controlPlane->stop([environment]() {
+            if (environment) {
                 GuiInterface::instance->logMessage(-1, "Waiting for the compute engine threads to join");
-                computeEnv->joinComputeEnvironment();
-                GuiInterface::instance->logMessage(-1, "Compute engines threads are joined");
-            }).detach();
-        } catch (...) {
-
-        }
+                environment->joinComputeEnvironment();
+            }
+        });
     } else {
         GuiInterface::instance->logMessage(-1, "Stop was already called");
     }
 }
 
 
-void MainWindow::logMessage(int /*threadId*/, QString message)
+void MainWindow::logMessage(int threadId, QString message)
+{
+    logModel->append(threadId, message);
+}
+
+void MainWindow::registerLogSource(int threadId, const QString name, const QString type)
+{
+    logModel->registerSource(threadId, name, type);
+    sourceFilter->addItem(name, threadId);
+    if (typeFilter->findData(type) < 0) {
+        typeFilter->addItem(QString("Type %1").arg(type), type);
+    }
+}
+
+void MainWindow::computationAborted(quint64 id)
+{
+    logModel->append(LogModel::GENERAL_SOURCE, QString("Computation with Id %1 aborted").arg(id));
+}
+
+void MainWindow::submissionFailed(long long /*time*/)
+{
+    logModel->append(LogModel::GENERAL_SOURCE, "The request was refused (the buffer is stopped)");
+}
+
+void MainWindow::tasksStopped()
 {
-    generalConsole->append(message);
+    logModel->append(LogModel::GENERAL_SOURCE, "Compute engines threads are joined");
 }
 
 #include <QThread>
@@ -157,7 +226,13 @@ std::string nameFromType(ComputationType ct) {
     case ComputationType::A : return std::string("A");
     case ComputationType::B : return std::string("B");
     case ComputationType::C : return std::string("C");
-    default: return std::string("?");
+    case ComputationType::D : return std::string("D");
+    case ComputationType::E : return std::string("E");
+    default:
+        if (auto kernel = KernelRegistry::instance().find(ct)) {
+            return std::string(kernel->typeName);
+        }
+        return std::string("?");
     }
 }
 
@@ -165,20 +240,15 @@ void MainWindow::launch(Computation c) {
     auto t = GuiInterface::instance->getCurrentTime();
     try {
         GuiInterface::instance->addComputeRequest(t, QString(nameFromType(c.computationType).c_str()));
-        std::thread([=](){
-            try {
-                auto id = computationManager->requestComputation(c);
-                GuiInterface::instance->addRequestStart(id, t);
-            } catch (ComputationManager::StopException& e) {}
-        }).detach();
+        // The request start is drawn once the manager has accepted the request
+        controlPlane->submit(c, t);
     } catch (ComputationManager::StopException& e) {}
 }
 
 void MainWindow::start1()
 {
     Computation sum(ComputationType::A);
-    sum.data->resize(10);
-    std::iota(sum.data->begin(), sum.data->end(), 0);
+    sum.setGenerator(Generator::iota(10));
 
     launch(sum);
 }
@@ -186,8 +256,7 @@ void MainWindow::start1()
 void MainWindow::start2()
 {
     Computation mult(ComputationType::B);
-    mult.data->resize(3);
-    std::fill(mult.data->begin(), mult.data->end(), 3);
+    mult.setGenerator(Generator::constant(3, 3));
 
     launch(mult);
 }
@@ -202,6 +271,24 @@ void MainWindow::start3()
     launch(div);
 }
 
+void MainWindow::start4()
+{
+    Computation scan(ComputationType::D);
+    scan.data->resize(5);
+    std::iota(scan.data->begin(), scan.data->end(), 1);
+
+    launch(scan);
+}
+
+void MainWindow::start5()
+{
+    Computation top = ComputeEngineE::topK(3);
+    top.data->resize(10);
+    std::iota(top.data->begin(), top.data->end(), 0);
+
+    launch(top);
+}
+
 void MainWindow::startTasks()
 {
     // Run the compute environment
@@ -231,6 +318,8 @@ void MainWindow::createToolbar()
     toolBar->addAction(start1Act);
     toolBar->addAction(start2Act);
     toolBar->addAction(start3Act);
+    toolBar->addAction(start4Act);
+    toolBar->addAction(start5Act);
 }
 
 
@@ -291,6 +380,16 @@ void MainWindow::createActions()
     start3Act->setStatusTip(tr("Start computation C"));
     CONNECT(start3Act, SIGNAL(triggered()), this, SLOT(start3()));
 
+    start4Act = new QAction(tr("Start D"), this);
+    start4Act->setShortcut(tr("Ctrl+4"));
+    start4Act->setStatusTip(tr("Start computation D"));
+    CONNECT(start4Act, SIGNAL(triggered()), this, SLOT(start4()));
+
+    start5Act = new QAction(tr("Start E"), this);
+    start5Act->setShortcut(tr("Ctrl+5"));
+    start5Act->setStatusTip(tr("Start computation E"));
+    CONNECT(start5Act, SIGNAL(triggered()), this, SLOT(start5()));
+
 }
 
 void MainWindow::updateMenus()
@@ -6,10 +6,13 @@
 #include "simview.h"
 
 #include <QThread>
-#include <QTextEdit>
+#include <QComboBox>
+#include <QListView>
 #include "computationmanager.h"
 #include "pcosynchro/pcothread.h"
 #include "computeenvironmentgui.h"
+#include "controlplane.h"
+#include "logmodel.h"
 
 class MainWindow : public QMainWindow
 {
@@ -18,6 +21,8 @@ private:
     std::shared_ptr<ComputationManager> computationManager;
     std::shared_ptr<QThread> guiThread;
     std::shared_ptr<ComputeEnvironmentGui> computeEnv;
+    // Submits, aborts and stops off the GUI thread
+    ControlPlane *controlPlane;
     void launch(Computation c);
 
 public:
@@ -28,7 +33,14 @@ public:
     char **argv;
 
     QDockWidget *dockGeneralConsole;
-    QTextEdit *generalConsole;
+    // The last messages, shown by a list view that only draws the visible ones
+    LogModel *logModel;
+    LogFilterModel *logFilter;
+    QListView *generalConsole;
+    QComboBox *sourceFilter;
+    QComboBox *typeFilter;
+    // True while the console shows its last message, it then follows the new ones
+    bool followLog{true};
 
     void readSettings();
     void writeSettings() const;
@@ -49,6 +61,8 @@ public:
     QAction *start1Act;
     QAction *start2Act;
     QAction *start3Act;
+    QAction *start4Act;
+    QAction *start5Act;
 
     QMenu *actionMenu;
     QToolBar *toolBar;
@@ -67,7 +81,13 @@ public slots:
     void start1();
     void start2();
     void start3();
+    void start4();
+    void start5();
     void logMessage(int threadId,QString message);
+    void registerLogSource(int threadId, const QString name, const QString type);
+    void computationAborted(quint64 id);
+    void submissionFailed(long long time);
+    void tasksStopped();
 };
 
 #endif // MAINWINDOW_H
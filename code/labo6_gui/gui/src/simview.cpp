@@ -27,8 +27,8 @@ int tasks[MAXTASKS];
 
 #define DIVFACTOR ((long long)(100000000))
 
-SimView::SimView(const std::shared_ptr<ComputationManager>& computationManager, QWidget */*parent*/)
-    : QGraphicsView(), computationManager(computationManager)
+SimView::SimView(ControlPlane *controlPlane, QWidget */*parent*/)
+    : QGraphicsView(), controlPlane(controlPlane)
 {
     nbTasks=0;
     nextTime=0;
@@ -87,7 +87,7 @@ void SimView::mousePressEvent(QMouseEvent *event)
           if (computeRequest) {
               auto id = computeRequest->id;
               computeRequest->setBrush(QColor(60,60,60));
-              computationManager->abortComputation(id);
+              controlPlane->abort(id);
               GuiInterface::instance->logMessage(-1, QString("Asked to abort computation with Id: %1").arg(id));
               auto time = GuiInterface::instance->getCurrentTime();
               int t = (int)(time/DIVFACTOR);
@@ -228,7 +228,7 @@ void SimView::addComputeRequest(long long time, QString text)
     item->show();
 }
 
-void SimView::addRequestStart(int id, long long time)
+void SimView::addRequestStart(quint64 id, long long time)
 {
     int t = (int)(time/DIVFACTOR);
     ComputeRequestItem *item;
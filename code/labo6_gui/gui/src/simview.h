@@ -8,6 +8,7 @@
 
 #include "connect.h"
 #include "computationmanager.h"
+#include "controlplane.h"
 
 class PeriodicTask
 {
@@ -35,8 +36,8 @@ public:
 class ComputeRequestItem : public QGraphicsRectItem
 {
 public:
-    int id{-1};
-    void setId(int i) {id = i; setBrush(QColor(0,0,255));}
+    RequestId id{NO_REQUEST};
+    void setId(RequestId i) {id = i; setBrush(QColor(0,0,255));}
 };
 
 class SimView : public QGraphicsView
@@ -45,9 +46,9 @@ class SimView : public QGraphicsView
 
 private:
     std::map<int, std::string> threadNames;
-    std::shared_ptr<ComputationManager> computationManager;
+    ControlPlane *controlPlane;
 public:
-    explicit SimView(const std::shared_ptr<ComputationManager>& computationManager, QWidget *parent =0);
+    explicit SimView(ControlPlane *controlPlane, QWidget *parent =0);
     void zoomIn();
     void zoomOut();
     void zoomFit();
@@ -74,7 +75,7 @@ public:
 public slots:
     void addThreadTrigger(int threadId,long long time);
     void addComputeRequest(long long time, QString text);
-    void addRequestStart(int id, long long time);
+    void addRequestStart(quint64 id, long long time);
     void addResult(long long time, QString text);
     void addTaskStart(int threadId,long long time);
     void addTaskEnd(int threadId,long long time);
@@ -0,0 +1,50 @@
+/**
+\file allocationhook.cpp
+\author agent
+\date 19.10.2026
+
+Ce fichier remplace les opérateurs new et delete globaux des tests pour que chaque allocation sur le tas soit
+comptée par AllocationCounter.
+*/
+
+#include <cstdlib>
+#include <new>
+
+#include "allocationcounter.h"
+
+void *operator new(std::size_t size) {
+   AllocationCounter::record();
+   if (void *p = std::malloc(size ? size : 1)) {
+      return p;
+   }
+   throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+   return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+   AllocationCounter::record();
+   return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+   return operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept {
+   std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+   std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+   std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+   std::free(p);
+}
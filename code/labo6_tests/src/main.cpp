@@ -1,9 +1,19 @@
 
 #include <gtest/gtest.h>
+#include <fstream>
+#include <future>
+#include <numeric>
+#include <pthread.h>
+#include <random>
+#include <thread>
 
 #include "pcotest.h"
 
 #include "computationmanager.h"
+#include "enginepool.h"
+#include "engineprofiler.h"
+#include "kernelcalibration.h"
+#include "kernelregistry.h"
 #include "testcomputengine.h"
 
 TEST(Pass, AlwaysPass) {
@@ -313,6 +323,1117 @@ TEST(Etape4, ResultsShouldArriveInOrderAndBufferMustStop) {
     })
 }
 
+TEST(Coalescing, IdenticalRequestsShouldShareExecution) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm(2);
+        cm.setRequestCoalescing(true);
+        Computation c(ComputationType::A);
+        c.data->assign({1.0, 2.0, 3.0});
+        Computation copy(ComputationType::A);
+        *copy.data = *c.data;
+        auto id1 = cm.requestComputation(c);
+        auto id2 = cm.requestComputation(copy);
+        // Would block on the full queue if it was not coalesced
+        auto id3 = cm.requestComputation(c);
+        auto req = cm.getWork(ComputationType::A);
+        ASSERT_EQ(id1, req.getId());
+        cm.provideResult(Result(req.getId(), 6.0));
+        for (auto id : {id1, id2, id3}) {
+            auto res = cm.getNextResult();
+            ASSERT_EQ(id, res.getId()) << "Every attached id should get the result in order";
+            ASSERT_EQ(6.0, res.getResult());
+        }
+    })
+}
+
+TEST(Coalescing, AbortShouldBePerId) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm(2);
+        cm.setRequestCoalescing(true);
+        Computation c(ComputationType::B);
+        c.data->assign({2.0, 3.0});
+        auto id1 = cm.requestComputation(c);
+        auto id2 = cm.requestComputation(c);
+        auto req = cm.getWork(ComputationType::B);
+        cm.abortComputation(id1);
+        ASSERT_TRUE(cm.continueWork(req.getId())) << "The execution is still wanted by the second id";
+        cm.provideResult(Result(req.getId(), 6.0));
+        auto res = cm.getNextResult();
+        ASSERT_EQ(id2, res.getId());
+        ASSERT_EQ(6.0, res.getResult());
+
+        auto id3 = cm.requestComputation(c);
+        auto id4 = cm.requestComputation(c);
+        req = cm.getWork(ComputationType::B);
+        cm.abortComputation(id4);
+        cm.abortComputation(id3);
+        ASSERT_FALSE(cm.continueWork(req.getId())) << "Nobody wants the execution anymore";
+    })
+}
+
+TEST(Coalescing, EveryExecutionWithTheSameHashShouldBeCompared) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm(3);
+        cm.setRequestCoalescing(true);
+        Computation changed(ComputationType::A);
+        changed.data->assign({1.0, 2.0, 3.0});
+        auto id1 = cm.requestComputation(changed);
+        // The first execution keeps the hash of {1, 2, 3} but not the data
+        changed.data->assign({4.0, 5.0, 6.0});
+        Computation c(ComputationType::A);
+        c.data->assign({1.0, 2.0, 3.0});
+        Computation copy(ComputationType::A);
+        *copy.data = *c.data;
+        auto id2 = cm.requestComputation(c);
+        auto id3 = cm.requestComputation(copy);
+        ASSERT_EQ(id1, cm.getWork(ComputationType::A).getId());
+        ASSERT_EQ(id2, cm.getWork(ComputationType::A).getId());
+        ASSERT_FALSE(cm.tryGetWork(ComputationType::A)) << "The copy should share the second execution";
+        cm.provideResult(Result(id1, 15.0));
+        cm.provideResult(Result(id2, 6.0));
+        ASSERT_EQ(15.0, cm.getNextResult().getResult());
+        ASSERT_EQ(6.0, cm.getNextResult().getResult());
+        auto res = cm.getNextResult();
+        ASSERT_EQ(id3, res.getId());
+        ASSERT_EQ(6.0, res.getResult());
+    })
+}
+
+TEST(RequestIds, StaleIdsShouldBeRejected) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm(2);
+        ComputationManager other(2);
+        auto id1 = cm.requestComputation(Computation(ComputationType::A));
+        ASSERT_EQ(id1, other.requestComputation(Computation(ComputationType::A))) << "Every buffer has its own ids";
+        auto req = cm.getWork(ComputationType::A);
+        cm.abortComputation(id1);
+        // The slot of the aborted id is reused
+        auto id2 = cm.requestComputation(Computation(ComputationType::A));
+        ASSERT_LT(id1, id2);
+        ASSERT_FALSE(cm.continueWork(req.getId())) << "The aborted id should stay stale";
+        cm.abortComputation(id1);
+        cm.provideResult(Result(id1, 1.0));
+        req = cm.getWork(ComputationType::A);
+        ASSERT_EQ(id2, req.getId());
+        ASSERT_TRUE(cm.continueWork(id2)) << "A stale id should not abort the id reusing its slot";
+        cm.provideResult(Result(id2, 2.0));
+        auto res = cm.getNextResult();
+        ASSERT_EQ(id2, res.getId());
+        ASSERT_EQ(2.0, res.getResult()) << "The result of a stale id should be ignored";
+        ASSERT_FALSE(cm.continueWork(id2)) << "A delivered id should be stale";
+    })
+}
+
+// Buffer starting at the end of the sequence numbers of its ids
+class ExhaustedComputationManager : public ComputationManager {
+public:
+    ExhaustedComputationManager() { nextSequence = MAX_SEQUENCE; }
+};
+
+TEST(RequestIds, ExhaustedIdsShouldThrow) {
+    ASSERT_DURATION_LE(1, {
+        ExhaustedComputationManager cm;
+        auto last = cm.requestComputation(Computation(ComputationType::A));
+        ASSERT_NE(NO_REQUEST, last);
+        ASSERT_THROW(cm.requestComputation(Computation(ComputationType::A)), std::length_error) << "The ids should not wrap";
+        ASSERT_EQ(last, cm.getWork(ComputationType::A).getId());
+    })
+}
+
+TEST(Drain, RunningRequestsShouldFinishAndQueuedOnesBeHandedBack) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        Computation c(ComputationType::A);
+        c.data->assign({1.0, 2.0});
+        auto running = cm.requestComputation(c);
+        auto queued1 = cm.requestComputation(Computation(ComputationType::A));
+        auto queued2 = cm.requestComputation(Computation(ComputationType::B));
+        auto req = cm.getWork(ComputationType::A);
+        ASSERT_EQ(running, req.getId());
+
+        auto drained = std::async(std::launch::async, [&cm]() { return cm.drain(std::chrono::milliseconds(500)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ASSERT_THROW(cm.requestComputation(c), std::exception) << "A draining buffer should refuse new requests";
+        cm.provideResult(Result(req.getId(), 3.0));
+        auto res = cm.getNextResult();
+        ASSERT_EQ(running, res.getId());
+        ASSERT_EQ(3.0, res.getResult());
+
+        auto neverStarted = drained.get();
+        ASSERT_EQ(2u, neverStarted.size());
+        ASSERT_EQ(ComputationType::A, neverStarted.at(queued1).computations.at(0).computationType);
+        ASSERT_EQ(ComputationType::B, neverStarted.at(queued2).computations.at(0).computationType);
+        ASSERT_THROW(cm.getNextResult(), std::exception) << "Nothing is left to deliver";
+    })
+}
+
+TEST(Drain, DrainShouldReturnOnceTheLastResultIsDelivered) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        auto id = cm.requestComputation(Computation(ComputationType::A));
+        auto req = cm.getWork(ComputationType::A);
+        // The deadline is far beyond the duration of the test
+        auto drained = std::async(std::launch::async, [&cm]() { return cm.drain(std::chrono::seconds(10)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        cm.provideResult(Result(req.getId(), 1.0));
+        ASSERT_EQ(id, cm.getNextResult().getId());
+        ASSERT_TRUE(drained.get().empty());
+    })
+}
+
+TEST(Drain, SharedExecutionShouldBeHandedBackUnderItsLiveIds) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        cm.setRequestCoalescing(true);
+        Computation c(ComputationType::A);
+        c.data->assign({1.0, 2.0});
+        auto id1 = cm.requestComputation(c);
+        auto id2 = cm.requestComputation(c);
+        // The execution is queued under the id that is aborted
+        cm.abortComputation(id1);
+
+        auto neverStarted = cm.drain(std::chrono::milliseconds(100));
+        ASSERT_EQ(1u, neverStarted.size());
+        ASSERT_EQ(1u, neverStarted.count(id2)) << "Only the id still wanted should be handed back";
+        ASSERT_EQ(2u, neverStarted.at(id2).computations.at(0).data->size());
+    })
+}
+
+TEST(Drain, QueuedGroupShouldBeHandedBackWhole) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        std::vector<Computation> computations;
+        for (double value : {1.0, 2.0, 3.0}) {
+            computations.emplace_back(ComputationType::A);
+            computations.back().data->assign({value});
+        }
+        auto groupId = cm.requestGroup(computations, Aggregator::sum());
+
+        auto neverStarted = cm.drain(std::chrono::milliseconds(50));
+        ASSERT_EQ(1u, neverStarted.size());
+        const auto& group = neverStarted.at(groupId);
+        ASSERT_EQ(3u, group.computations.size());
+        for (size_t i = 0; i < computations.size(); ++i) {
+            ASSERT_EQ(*computations[i].data, *group.computations[i].data) << "The computations should be in order";
+        }
+        ASSERT_TRUE(group.aggregator.has_value());
+        ASSERT_EQ(5.0, group.aggregator->combiner(2.0, 3.0));
+
+        // A group with a dispatched computation has started, it is left to finish
+        ComputationManager started;
+        started.requestGroup(computations, Aggregator::sum());
+        started.getWork(ComputationType::A);
+        ASSERT_TRUE(started.drain(std::chrono::milliseconds(50)).empty());
+    })
+}
+
+TEST(ScatterGather, SegmentsShouldBeUsedInPlace) {
+    ASSERT_DURATION_LE(1, {
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineA engineA(cm);
+        ComputeEngineC engineC(cm);
+        engineA.startThread();
+        engineC.startThread();
+
+        auto shards = std::make_shared<std::vector<std::vector<double>>>();
+        shards->push_back(std::vector<double>({1.0, 2.0, 3.0}));
+        shards->push_back(std::vector<double>());
+        shards->push_back(std::vector<double>({4.0}));
+        std::vector<DataSegment> segments;
+        for (const auto& shard : *shards) {
+            segments.push_back(DataSegment({shard.data(), shard.size()}));
+        }
+
+        Computation sum(ComputationType::A);
+        sum.setSegments(segments, shards);
+        // The division operands are split between the shards
+        Computation div(ComputationType::C);
+        div.setSegments(std::vector<DataSegment>({DataSegment({&shards->at(0)[2], 1}), DataSegment({&shards->at(2)[0], 1})}), shards);
+        shards.reset();
+
+        cm->requestComputation(sum);
+        cm->requestComputation(div);
+        ASSERT_EQ(10.0, cm->getNextResult().getResult());
+        ASSERT_EQ(0.75, cm->getNextResult().getResult());
+
+        cm->stop();
+        engineA.join();
+        engineC.join();
+    })
+}
+
+TEST(ScatterGather, DataChangedBeforeExecutionShouldBeRead) {
+    ASSERT_DURATION_LE(1, {
+        auto cm = std::make_shared<ComputationManager>();
+        Computation sum(ComputationType::A);
+        sum.data->assign({1.0, 2.0});
+        cm->requestComputation(sum);
+        // The vector is reallocated before an engine takes the request
+        sum.data->assign(100000, 1.0);
+
+        ComputeEngineA engine(cm);
+        engine.startThread();
+        ASSERT_EQ(100000.0, cm->getNextResult().getResult());
+
+        cm->stop();
+        engine.join();
+    })
+}
+
+TEST(Generators, GeneratedDataShouldBeEvaluatedByTheEngines) {
+    ASSERT_DURATION_LE(1, {
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineA engineA(cm);
+        ComputeEngineB engineB(cm);
+        ComputeEngineD engineD(cm);
+        engineA.startThread();
+        engineB.startThread();
+        engineD.startThread();
+
+        Computation sum(ComputationType::A);
+        sum.setGenerator(Generator::iota(1000000));
+        Computation mult(ComputationType::B);
+        mult.setGenerator(Generator::constant(3, 3.0));
+        // Every other element of the matrix, no closed form there
+        auto matrix = std::make_shared<std::vector<double>>(6);
+        std::iota(matrix->begin(), matrix->end(), 1.0);
+        Computation strided(ComputationType::A);
+        strided.setGenerator(Generator::strided(matrix->data(), 3, 2), matrix);
+        Computation scan(ComputationType::D);
+        scan.setGenerator(Generator::affine(4, 1.0, 2.0));
+
+        cm->requestComputation(sum);
+        cm->requestComputation(mult);
+        cm->requestComputation(strided);
+        cm->requestComputation(scan);
+        ASSERT_EQ(499999500000.0, cm->getNextResult().getResult()) << "Sum of the progression in closed form";
+        ASSERT_EQ(27.0, cm->getNextResult().getResult());
+        ASSERT_EQ(9.0, cm->getNextResult().getResult());
+        auto res = cm->getNextResult();
+        ASSERT_EQ(std::vector<double>({1.0, 4.0, 9.0, 16.0}), *res.getValues());
+
+        cm->stop();
+        engineA.join();
+        engineB.join();
+        engineD.join();
+    })
+}
+
+TEST(Groups, GroupResultsShouldBeCombinedInTheBuffer) {
+    ASSERT_DURATION_LE(1, {
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineA engine1(cm);
+        ComputeEngineA engine2(cm);
+        engine1.startThread();
+        engine2.startThread();
+
+        Computation single(ComputationType::A);
+        single.setGenerator(Generator::iota(4));
+        // More computations than the queue can hold
+        std::vector<Computation> group;
+        for (int i = 0; i < 100; ++i) {
+            Computation c(ComputationType::A);
+            c.setGenerator(Generator::constant(2, i));
+            group.push_back(c);
+        }
+        auto singleId = cm->requestComputation(single);
+        auto sumId = cm->requestGroup(group, Aggregator::sum());
+        auto maxId = cm->requestGroup(group, Aggregator::max());
+        auto emptyId = cm->requestGroup({}, Aggregator::product());
+        auto res = cm->getNextResult();
+        ASSERT_EQ(singleId, res.getId());
+        ASSERT_EQ(6.0, res.getResult());
+        res = cm->getNextResult();
+        ASSERT_EQ(sumId, res.getId()) << "The group should have a single result in its place";
+        ASSERT_EQ(9900.0, res.getResult());
+        res = cm->getNextResult();
+        ASSERT_EQ(maxId, res.getId());
+        ASSERT_EQ(198.0, res.getResult());
+        res = cm->getNextResult();
+        ASSERT_EQ(emptyId, res.getId());
+        ASSERT_EQ(1.0, res.getResult()) << "An empty group should give the initial value";
+
+        cm->stop();
+        engine1.join();
+        engine2.join();
+    })
+}
+
+TEST(Groups, AbortedGroupShouldAbortItsComputations) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        auto groupId = cm.requestGroup(std::vector<Computation>(3, Computation(ComputationType::A)), Aggregator::sum());
+        auto req = cm.getWork(ComputationType::A);
+        ASSERT_NE(groupId, req.getId());
+        ASSERT_TRUE(cm.continueWork(req.getId())) << "The computations go on while the group is wanted";
+        cm.abortComputation(req.getId());
+        ASSERT_TRUE(cm.continueWork(req.getId())) << "A computation should not be aborted without its group";
+        cm.abortComputation(groupId);
+        ASSERT_FALSE(cm.continueWork(req.getId()));
+        auto id = cm.requestComputation(Computation(ComputationType::A));
+        ASSERT_EQ(id, cm.getWork(ComputationType::A).getId()) << "The queued computations should be removed";
+    })
+}
+
+TEST(Groups, GroupAbortedOnFullQueueShouldStopBeingQueued) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm(2);
+        ComputationManager other;
+        std::vector<Computation> computations(3, Computation(ComputationType::A));
+        // Every buffer has its own ids, the other one tells the id of the group before it is returned
+        auto groupId = other.requestGroup(computations, Aggregator::sum());
+        RequestId returned = 0;
+        // The third computation waits for space in the queue
+        auto t = std::thread([&](){returned = cm.requestGroup(computations, Aggregator::sum());});
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        cm.abortComputation(groupId);
+        t.join();
+        ASSERT_EQ(groupId, returned);
+        auto id = cm.requestComputation(Computation(ComputationType::A));
+        ASSERT_EQ(id, cm.getWork(ComputationType::A).getId()) << "No computation of the group should be left";
+    })
+}
+
+TEST(PackedIntegers, CompressedCountersShouldBeReducedByTheEngines) {
+    ASSERT_DURATION_LE(1, {
+        // Counters growing by small steps, with a few resets and one huge jump
+        std::vector<int64_t> counters(1000);
+        std::mt19937 generator(7);
+        int64_t counter = 0;
+        for (size_t i = 0; i < counters.size(); ++i) {
+            counter = i % 300 == 299 ? 0 : counter + static_cast<int64_t>(generator() % 16);
+            counters[i] = i == 500 ? INT64_MAX : counter;
+        }
+        auto packed = PackedIntegers::encode(counters);
+        ASSERT_EQ(counters.size(), packed->size());
+        ASSERT_EQ(8u, packed->blockCount());
+        for (size_t i = 0; i < counters.size(); ++i) {
+            ASSERT_EQ(counters[i], packed->at(i)) << "at " << i;
+        }
+        auto plain = std::make_shared<std::vector<double>>(counters.begin(), counters.end());
+        Payload payload(packed);
+        ASSERT_TRUE(payload.sameContent(Payload(plain)));
+        ASSERT_TRUE(Payload(plain).sameContent(payload));
+        ASSERT_EQ(Payload(plain).hash(), payload.hash());
+        ASSERT_EQ(plain->at(777), payload.at(777));
+
+        // Small steps need a few bits : a block without the jump is compressed more than 4 times
+        auto small = PackedIntegers::encode(std::vector<int64_t>(counters.begin(), counters.begin() + 256));
+        ASSERT_LT(small->compressedBytes() * 4, 256 * sizeof(double));
+
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineA engineA(cm);
+        ComputeEngineBatch batchB(cm, ComputationType::B);
+        engineA.startThread();
+        batchB.startThread();
+        Computation sum(ComputationType::A);
+        counters[500] = 0;
+        sum.setPacked(PackedIntegers::encode(counters));
+        Computation mult(ComputationType::B);
+        mult.setPacked(PackedIntegers::encode(std::vector<int64_t>({-2, 3, 5})));
+        cm->requestComputation(sum);
+        cm->requestComputation(mult);
+        ASSERT_EQ(static_cast<double>(std::accumulate(counters.begin(), counters.end(), int64_t(0))), cm->getNextResult().getResult());
+        ASSERT_EQ(-30.0, cm->getNextResult().getResult());
+
+        cm->stop();
+        engineA.join();
+        batchB.join();
+    })
+}
+
+TEST(PackedIntegers, ConstantAndSingleValuesShouldBeDecoded) {
+    ASSERT_DURATION_LE(1, {
+        // The deltas of a constant block take no bit at all
+        auto constant = PackedIntegers::encode(std::vector<int64_t>(10, -7));
+        ASSERT_EQ(1u, constant->blockCount());
+        for (size_t i = 0; i < 10; ++i) {
+            ASSERT_EQ(-7, constant->at(i)) << "at " << i;
+        }
+        double decoded[PackedIntegers::BLOCK_SIZE];
+        constant->decodeBlock(0, decoded);
+        ASSERT_EQ(-7.0, decoded[9]);
+
+        auto single = PackedIntegers::encode(std::vector<int64_t>({INT64_MIN}));
+        ASSERT_EQ(1u, single->size());
+        ASSERT_EQ(INT64_MIN, single->at(0));
+        single->decodeBlock(0, decoded);
+        ASSERT_EQ(static_cast<double>(INT64_MIN), decoded[0]);
+
+        // A last block of a single value after a constant block
+        auto tail = PackedIntegers::encode(std::vector<int64_t>(PackedIntegers::BLOCK_SIZE + 1, 5));
+        ASSERT_EQ(2u, tail->blockCount());
+        ASSERT_EQ(5, tail->at(PackedIntegers::BLOCK_SIZE));
+        ASSERT_EQ(5, tail->at(PackedIntegers::BLOCK_SIZE - 1));
+    })
+}
+
+TEST(Scan, SmallScanShouldGiveEveryPrefixSum) {
+    ASSERT_DURATION_LE(1, {
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineD engine(cm);
+        engine.startThread();
+
+        Computation scan(ComputationType::D);
+        scan.data->resize(10);
+        std::iota(scan.data->begin(), scan.data->end(), 1);
+        cm->requestComputation(scan);
+        auto res = cm->getNextResult();
+        ASSERT_EQ(55.0, res.getResult());
+        ASSERT_TRUE(res.getValues());
+        std::vector<double> expected(10);
+        std::partial_sum(scan.data->begin(), scan.data->end(), expected.begin());
+        ASSERT_EQ(expected, *res.getValues());
+
+        cm->stop();
+        engine.join();
+    })
+}
+
+TEST(Scan, LargeScanShouldBeSplitBetweenEngines) {
+    ASSERT_DURATION_LE(2, {
+        auto cm = std::make_shared<ComputationManager>();
+        cm->setPartitioner(ComputationType::D, ComputeEngineD::partitioner(3));
+        std::vector<std::unique_ptr<ComputeEngineD>> engines;
+        for (int i = 0; i < 3; ++i) {
+            engines.push_back(std::make_unique<ComputeEngineD>(cm));
+            engines.back()->startThread();
+        }
+
+        size_t size = ComputeEngineD::PARALLEL_THRESHOLD + 12345;
+        Computation scan(ComputationType::D);
+        scan.data->assign(size, 1.0);
+        Computation small(ComputationType::D);
+        small.data->assign(3, 2.0);
+        auto id = cm->requestComputation(scan);
+        cm->requestComputation(small);
+
+        auto res = cm->getNextResult();
+        ASSERT_EQ(id, res.getId());
+        ASSERT_EQ(static_cast<double>(size), res.getResult());
+        ASSERT_EQ(size, res.getValues()->size());
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(static_cast<double>(i + 1), res.getValues()->at(i)) << "at index " << i;
+        }
+        ASSERT_EQ(6.0, cm->getNextResult().getResult());
+
+        cm->stop();
+        for (auto& engine : engines) {
+            engine->join();
+        }
+    })
+}
+
+TEST(Selection, SmallSelectionShouldUseOneEngine) {
+    ASSERT_DURATION_LE(1, {
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineE engine(cm);
+        engine.startThread();
+
+        auto top = ComputeEngineE::topK(3);
+        top.data->assign({5.0, -1.0, 9.0, 3.0, NAN, 7.0});
+        auto median = ComputeEngineE::quantiles(std::vector<double>({0.0, 0.5, 1.0}));
+        median.data = top.data;
+        cm->requestComputation(top);
+        cm->requestComputation(median);
+        ASSERT_EQ(std::vector<double>({9.0, 7.0, 5.0}), *cm->getNextResult().getValues());
+        ASSERT_EQ(std::vector<double>({-1.0, 5.0, 9.0}), *cm->getNextResult().getValues()) << "NaN should be ignored";
+
+        cm->stop();
+        engine.join();
+    })
+}
+
+TEST(Selection, LargeSelectionShouldBeSplitBetweenEngines) {
+    ASSERT_DURATION_LE(5, {
+        auto cm = std::make_shared<ComputationManager>();
+        cm->setPartitioner(ComputationType::E, ComputeEngineE::partitioner(3));
+        std::vector<std::unique_ptr<ComputeEngineE>> engines;
+        for (int i = 0; i < 3; ++i) {
+            engines.push_back(std::make_unique<ComputeEngineE>(cm));
+            engines.back()->startThread();
+        }
+
+        auto data = std::make_shared<std::vector<double>>(ComputeEngineE::PARALLEL_THRESHOLD + 777);
+        std::mt19937_64 generator(42);
+        std::normal_distribution<double> distribution(10.0, 100.0);
+        std::generate(data->begin(), data->end(), [&](){return distribution(generator);});
+        std::vector<double> sorted(*data);
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<double> q({0.0, 0.01, 0.5, 0.999, 1.0});
+
+        auto top = ComputeEngineE::topK(5);
+        top.data = data;
+        auto exact = ComputeEngineE::quantiles(q);
+        exact.data = data;
+        auto approximate = ComputeEngineE::quantiles(q, true);
+        approximate.data = data;
+        cm->requestComputation(top);
+        cm->requestComputation(exact);
+        cm->requestComputation(approximate);
+
+        auto topValues = *cm->getNextResult().getValues();
+        ASSERT_EQ(std::vector<double>(sorted.rbegin(), sorted.rbegin() + 5), topValues);
+        auto exactValues = *cm->getNextResult().getValues();
+        auto approximateValues = *cm->getNextResult().getValues();
+        ASSERT_EQ(q.size(), exactValues.size());
+        for (size_t i = 0; i < q.size(); ++i) {
+            double expected = sorted[SelectionQuery::rank(q[i], sorted.size())];
+            ASSERT_EQ(expected, exactValues[i]) << "quantile " << q[i];
+            ASSERT_NEAR(expected, approximateValues[i], std::abs(expected) / 1024.0) << "quantile " << q[i];
+        }
+
+        cm->stop();
+        for (auto& engine : engines) {
+            engine->join();
+        }
+    })
+}
+
+TEST(Selection, LargeSelectionWithoutPartitionerShouldUseRadix) {
+    ASSERT_DURATION_LE(5, {
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineE engine(cm);
+        engine.startThread();
+
+        auto data = std::make_shared<std::vector<double>>(ComputeEngineE::PARALLEL_THRESHOLD + 777);
+        std::mt19937_64 generator(7);
+        std::uniform_real_distribution<double> distribution(-1000.0, 1000.0);
+        std::generate(data->begin(), data->end(), [&](){return distribution(generator);});
+        std::vector<double> sorted(*data);
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<double> q({0.0, 0.25, 0.5, 1.0});
+
+        auto exact = ComputeEngineE::quantiles(q);
+        exact.data = data;
+        auto approximate = ComputeEngineE::quantiles(q, true);
+        approximate.data = data;
+        cm->requestComputation(exact);
+        cm->requestComputation(approximate);
+
+        auto exactValues = *cm->getNextResult().getValues();
+        auto approximateValues = *cm->getNextResult().getValues();
+        ASSERT_EQ(q.size(), exactValues.size());
+        for (size_t i = 0; i < q.size(); ++i) {
+            double expected = sorted[SelectionQuery::rank(q[i], sorted.size())];
+            ASSERT_EQ(expected, exactValues[i]) << "quantile " << q[i];
+            ASSERT_NEAR(expected, approximateValues[i], std::abs(expected) / 1024.0) << "quantile " << q[i];
+        }
+
+        cm->stop();
+        engine.join();
+    })
+}
+
+TEST(CacheAffinity, RequestOnTheSameBufferShouldGoFirst) {
+    ASSERT_DURATION_LE(1, {
+        // The test thread stays on its CPU
+        cpu_set_t previous;
+        cpu_set_t current;
+        pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous);
+        CPU_ZERO(&current);
+        CPU_SET(sched_getcpu(), &current);
+        pthread_setaffinity_np(pthread_self(), sizeof(current), &current);
+
+        ComputationManager cm;
+        cm.setHeadOfLineWindow(0);
+        cm.setCacheAffinity(true);
+        Computation hot(ComputationType::A);
+        hot.data->assign(8, 1.0);
+        Computation cold(ComputationType::A);
+        cold.data->assign(8, 2.0);
+        cm.requestComputation(hot);
+        cm.getWork(ComputationType::A);
+        auto coldId = cm.requestComputation(cold);
+        auto hotId = cm.requestComputation(hot);
+        ASSERT_EQ(hotId, cm.getWork(ComputationType::A).getId()) << "The data of hot is in the caches of this CPU";
+        ASSERT_EQ(coldId, cm.getWork(ComputationType::A).getId());
+
+        pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+    })
+}
+
+TEST(BandwidthGovernor, BulkRequestsShouldBeCapped) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        cm.setBandwidthGovernor(true);
+        Computation bulk(ComputationType::A);
+        bulk.data->assign(ComputationManager::BULK_MIN_BYTES / sizeof(double), 1.0);
+        Computation small(ComputationType::A);
+        small.data->assign(8, 1.0);
+        auto bulk1 = cm.requestComputation(bulk);
+        auto bulk2 = cm.requestComputation(bulk);
+        auto small1 = cm.requestComputation(small);
+        ASSERT_EQ(1u, cm.getBulkLimit());
+        ASSERT_EQ(bulk1, cm.getWork(ComputationType::A).getId());
+        ASSERT_EQ(small1, cm.getWork(ComputationType::A).getId()) << "A single bulk request runs at once at first";
+        cm.provideResult(Result(bulk1, 0.0));
+        ASSERT_EQ(2u, cm.getBulkLimit()) << "The governor tries one more concurrent bulk request";
+        ASSERT_EQ(bulk2, cm.getWork(ComputationType::A).getId());
+    })
+}
+
+TEST(BandwidthGovernor, AbortedBulkRequestShouldKeepItsPlaceUntilItsEngineStops) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        cm.setBandwidthGovernor(true);
+        Computation bulk(ComputationType::A);
+        bulk.data->assign(ComputationManager::BULK_MIN_BYTES / sizeof(double), 1.0);
+        auto bulk1 = cm.requestComputation(bulk);
+        auto bulk2 = cm.requestComputation(Computation(bulk));
+        ASSERT_EQ(bulk1, cm.getWork(ComputationType::A).getId());
+        cm.abortComputation(bulk1);
+        ASSERT_FALSE(cm.tryGetWork(ComputationType::A).has_value()) << "The aborted request is still streaming";
+        ASSERT_FALSE(cm.continueWork(bulk1));
+        ASSERT_EQ(bulk2, cm.getWork(ComputationType::A).getId());
+        ASSERT_EQ(1u, cm.getBulkLimit()) << "An aborted request gives no bandwidth measure";
+    })
+}
+
+TEST(ConsumerAssist, BlockedConsumerShouldExecuteQueuedRequests) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        cm.setInlineExecutor(ComputationType::A, ComputeEngineA::compute);
+        cm.setInlineExecutor(ComputationType::B, ComputeEngineB::compute);
+        cm.setConsumerAssist(true);
+        Computation sum(ComputationType::A);
+        sum.data->assign({1.0, 2.0, 3.0});
+        Computation mult(ComputationType::B);
+        mult.setGenerator(Generator::constant(4, 2.0));
+        Computation div(ComputationType::C);
+        div.data->assign({1.0, 4.0});
+        auto id1 = cm.requestComputation(sum);
+        auto id2 = cm.requestComputation(mult);
+        auto id3 = cm.requestComputation(div);
+        // There is no compute engine at all
+        auto res = cm.getNextResult();
+        ASSERT_EQ(id1, res.getId());
+        ASSERT_EQ(6.0, res.getResult());
+        res = cm.getNextResult();
+        ASSERT_EQ(id2, res.getId());
+        ASSERT_EQ(16.0, res.getResult());
+        // Without inline executor, the division is left to an engine
+        auto req = cm.getWork(ComputationType::C);
+        ASSERT_EQ(id3, req.getId());
+    })
+}
+
+TEST(ConsumerAssist, BulkRequestExecutedByTheConsumerShouldBeGoverned) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        cm.setBandwidthGovernor(true);
+        cm.setInlineExecutor(ComputationType::A, ComputeEngineA::compute);
+        cm.setConsumerAssist(true);
+        Computation bulk(ComputationType::A);
+        bulk.data->assign(ComputationManager::BULK_MIN_BYTES / sizeof(double), 1.0);
+        auto id = cm.requestComputation(bulk);
+        auto res = cm.getNextResult();
+        ASSERT_EQ(id, res.getId());
+        ASSERT_EQ(2u, cm.getBulkLimit()) << "The bulk request executed by the consumer should be measured";
+    })
+}
+
+TEST(HeadOfLine, BlockingHeadShouldBeReported) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        Computation slow(ComputationType::B);
+        slow.data->assign(32, 1.0);
+        Computation fast(ComputationType::A);
+        fast.data->assign(4, 1.0);
+        auto slowId = cm.requestComputation(slow);
+        auto fastId = cm.requestComputation(fast);
+        std::string report;
+        cm.setHeadOfLineReporter(std::chrono::milliseconds(0), [&report](const std::string& text) { report = text; });
+        auto slowReq = cm.getWork(ComputationType::B);
+        auto fastReq = cm.getWork(ComputationType::A);
+        cm.provideResult(Result(fastReq.getId(), 4.0));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cm.provideResult(Result(slowReq.getId(), 32.0));
+        ASSERT_EQ(slowId, cm.getNextResult().getId());
+        ASSERT_EQ(fastId, cm.getNextResult().getId());
+
+        auto stalls = cm.getWorstStalls();
+        ASSERT_EQ(1u, stalls.size());
+        ASSERT_EQ(slowId, stalls[0].id);
+        ASSERT_EQ(ComputationType::B, stalls[0].type);
+        ASSERT_EQ(32u, stalls[0].payloadSize);
+        ASSERT_EQ(1u, stalls[0].piledUp);
+        ASSERT_GE(stalls[0].duration, std::chrono::milliseconds(20));
+        ASSERT_NE(std::string::npos, report.find("request " + std::to_string(slowId))) << report;
+    })
+}
+
+TEST(HeadOfLine, ResultsWithinToleranceShouldPassTheHead) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        cm.setReorderingTolerance(1);
+        auto id1 = cm.requestComputation(Computation(ComputationType::A));
+        auto id2 = cm.requestComputation(Computation(ComputationType::A));
+        auto id3 = cm.requestComputation(Computation(ComputationType::A));
+        cm.provideResult(Result(id3, 3.0));
+        cm.provideResult(Result(id2, 2.0));
+        ASSERT_EQ(id2, cm.getNextResult().getId()) << "The result right after the head should not wait for it";
+        cm.provideResult(Result(id1, 1.0));
+        ASSERT_EQ(id1, cm.getNextResult().getId()) << "The result two ids after the head should wait for it";
+        ASSERT_EQ(id3, cm.getNextResult().getId());
+    })
+}
+
+TEST(HeadOfLine, ToleranceShouldCountPendingResultsNotIds) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        cm.setReorderingTolerance(1);
+        auto id1 = cm.requestComputation(Computation(ComputationType::A));
+        auto id2 = cm.requestComputation(Computation(ComputationType::A));
+        auto id3 = cm.requestComputation(Computation(ComputationType::A));
+        cm.abortComputation(id2);
+        cm.provideResult(Result(id3, 3.0));
+        ASSERT_EQ(id3, cm.getNextResult().getId()) << "An aborted id should not count in the tolerance";
+        cm.provideResult(Result(id1, 1.0));
+        ASSERT_EQ(id1, cm.getNextResult().getId());
+
+        // The computations of a group do not count either
+        cm.setReorderingTolerance(2);
+        auto groupId = cm.requestGroup(std::vector<Computation>(5, Computation(ComputationType::A)), Aggregator::sum());
+        auto id4 = cm.requestComputation(Computation(ComputationType::B));
+        cm.provideResult(Result(cm.getWork(ComputationType::B).getId(), 4.0));
+        ASSERT_EQ(id4, cm.getNextResult().getId()) << "The result right after the group should not wait for it";
+        cm.abortComputation(groupId);
+    })
+}
+
+TEST(HeadOfLine, LaterPhasesOfTheHeadShouldGoFirst) {
+    // A request in two phases of one part each
+    class TwoPhaseJob : public PartitionedJob {
+    public:
+        std::vector<unsigned> phaseParts() const override { return {0}; }
+        bool nextPhase() override { return ++phase < 2; }
+        Result result(RequestId id) const override { return Result(id, phase); }
+    };
+
+    for (size_t window : {0, 1}) {
+        ASSERT_DURATION_LE(1, {
+            ComputationManager cm;
+            cm.setHeadOfLineWindow(window);
+            cm.setPartitioner(ComputationType::A, [](const Payload &payload, const std::vector<double> &) {
+                return payload.size() > 4 ? std::make_shared<TwoPhaseJob>() : nullptr;
+            });
+            Computation large(ComputationType::A);
+            large.data->assign(8, 1.0);
+            Computation small(ComputationType::A);
+            small.data->assign(2, 1.0);
+            auto largeId = cm.requestComputation(large);
+            cm.getWork(ComputationType::A);
+            auto smallId = cm.requestComputation(small);
+            // The second phase is queued after the small request
+            cm.provideResult(Result(largeId, 0.0));
+            auto expected = window == 0 ? smallId : largeId;
+            ASSERT_EQ(expected, cm.getWork(ComputationType::A).getId()) << "window " << window;
+        })
+    }
+}
+
+TEST(HeadOfLine, HeadShouldGoBeforeCacheAffineRequests) {
+    ASSERT_DURATION_LE(1, {
+        cpu_set_t previous;
+        cpu_set_t current;
+        pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous);
+        CPU_ZERO(&current);
+        CPU_SET(sched_getcpu(), &current);
+        pthread_setaffinity_np(pthread_self(), sizeof(current), &current);
+
+        ComputationManager cm;
+        cm.setCacheAffinity(true);
+        Computation hot(ComputationType::A);
+        hot.data->assign(8, 1.0);
+        Computation cold(ComputationType::A);
+        cold.data->assign(8, 2.0);
+        auto hotId = cm.requestComputation(hot);
+        cm.getWork(ComputationType::A);
+        cm.provideResult(Result(hotId, 8.0));
+        cm.getNextResult();
+        auto coldId = cm.requestComputation(cold);
+        hotId = cm.requestComputation(hot);
+        ASSERT_EQ(coldId, cm.getWork(ComputationType::A).getId()) << "getNextResult waits for cold";
+        ASSERT_EQ(hotId, cm.getWork(ComputationType::A).getId());
+
+        pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+    })
+}
+
+TEST(EnginePool, BuffersShouldBeServedByWeight) {
+    ASSERT_DURATION_LE(1, {
+        auto pool = std::make_shared<EnginePool>();
+        auto heavy = std::make_shared<ComputationManager>();
+        auto light = std::make_shared<ComputationManager>();
+        pool->attach(heavy, 3.0);
+        pool->attach(light, 1.0);
+        Computation c(ComputationType::A);
+        c.data->assign({1.0, 2.0, 3.0});
+        for (int i = 0; i < 8; ++i) {
+            heavy->requestComputation(c);
+            light->requestComputation(c);
+        }
+        // The pool is used here like a compute engine would, the results go back to the buffer of the request
+        for (int i = 0; i < 8; ++i) {
+            auto req = pool->getWork(ComputationType::A);
+            ASSERT_TRUE(pool->continueWork(req.getId()));
+            pool->provideResult(Result(req.getId(), 6.0));
+        }
+        ASSERT_EQ(6 * 4.0, pool->served(heavy)) << "Three times the work of the light buffer";
+        ASSERT_EQ(2 * 4.0, pool->served(light));
+        for (int i = 0; i < 2; ++i) {
+            ASSERT_EQ(6.0, light->getNextResult().getResult());
+        }
+
+        // Two engines serve three buffers
+        auto third = std::make_shared<ComputationManager>();
+        pool->attach(third);
+        ComputeEngineA engine1(pool);
+        ComputeEngineA engine2(pool);
+        engine1.startThread();
+        engine2.startThread();
+        for (int i = 0; i < 8; ++i) {
+            ASSERT_EQ(6.0, heavy->getNextResult().getResult());
+        }
+        for (int i = 0; i < 6; ++i) {
+            ASSERT_EQ(6.0, light->getNextResult().getResult());
+        }
+        third->requestComputation(c);
+        ASSERT_EQ(6.0, third->getNextResult().getResult());
+
+        pool->stop();
+        engine1.join();
+        engine2.join();
+    })
+}
+
+TEST(Calibration, CalibrationShouldBeCachedPerHost) {
+    ASSERT_DURATION_LE(1, {
+        std::string path = testing::TempDir() + "labo6_calibration/kernels.conf";
+        std::remove(path.c_str());
+        auto calibrated = KernelCalibration::ensureCalibrated(path);
+        KernelConfiguration loaded;
+        ASSERT_TRUE(KernelCalibration::load(path, loaded)) << "The calibration should be written to the cache file";
+        ASSERT_EQ(calibrated.accumulators, loaded.accumulators);
+        ASSERT_EQ(calibrated.blockSize, loaded.blockSize);
+
+        // A cache file written on another host is not used
+        std::ofstream(path) << "another host" << std::endl << "2 1024" << std::endl;
+        ASSERT_FALSE(KernelCalibration::load(path, loaded));
+        std::remove(path.c_str());
+    })
+}
+
+TEST(Profiler, EngineSamplesShouldBeWrittenAsPprof) {
+    ASSERT_DURATION_LE(2, {
+        EngineProfiler::instance().start(1000);
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineA engine(cm);
+        engine.startThread();
+        Computation c(ComputationType::A);
+        c.data->assign(1000000, 1.0);
+        // The engine is fast, it computes until it has been sampled
+        for (int i = 0; i < 500 && EngineProfiler::instance().sampleCount() == 0; ++i) {
+            cm->requestComputation(c);
+            ASSERT_EQ(1000000.0, cm->getNextResult().getResult());
+        }
+        cm->stop();
+        engine.join();
+        EngineProfiler::instance().stop();
+
+        ASSERT_GT(EngineProfiler::instance().sampleCount(), 0u) << "The engine should have been sampled";
+        std::string path = testing::TempDir() + "labo6_engines.pprof";
+        ASSERT_TRUE(EngineProfiler::instance().writeProfile(path));
+        std::ifstream file(path, std::ios::binary);
+        std::string profile((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        ASSERT_NE(std::string::npos, profile.find("engine_type"));
+        ASSERT_NE(std::string::npos, profile.find("request_id"));
+        std::remove(path.c_str());
+    })
+}
+
+TEST(Profiler, RegisteredEnginesShouldBeSampledAgainAfterARestart) {
+    ASSERT_DURATION_LE(2, {
+        EngineProfiler::instance().start(1000);
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineA engine(cm);
+        engine.startThread();
+        Computation c(ComputationType::A);
+        c.data->assign(1000000, 1.0);
+        // The engine registers when it starts, its first request ensures it did
+        cm->requestComputation(c);
+        ASSERT_EQ(1000000.0, cm->getNextResult().getResult());
+        EngineProfiler::instance().stop();
+
+        EngineProfiler::instance().start(1000);
+        for (int i = 0; i < 500 && EngineProfiler::instance().sampleCount() == 0; ++i) {
+            cm->requestComputation(c);
+            ASSERT_EQ(1000000.0, cm->getNextResult().getResult());
+        }
+        EngineProfiler::instance().stop();
+        ASSERT_GT(EngineProfiler::instance().sampleCount(), 0u) << "The engine should have been sampled again";
+
+        cm->stop();
+        engine.join();
+    })
+}
+
+TEST(Batch, SmallRequestsShouldBeTakenTogether) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        auto id1 = cm.requestComputation(Computation(ComputationType::A));
+        cm.requestComputation(Computation(ComputationType::B));
+        auto id2 = cm.requestComputation(Computation(ComputationType::A));
+        Computation large(ComputationType::A);
+        large.data->resize(100);
+        auto id3 = cm.requestComputation(large);
+        std::vector<Request> batch;
+        cm.getWorkBatch(ComputationType::A, batch, 10, 10);
+        ASSERT_EQ(2u, batch.size()) << "The large request should not be batched";
+        ASSERT_EQ(id1, batch[0].getId());
+        ASSERT_EQ(id2, batch[1].getId());
+        cm.getWorkBatch(ComputationType::A, batch, 10, 10);
+        ASSERT_EQ(1u, batch.size());
+        ASSERT_EQ(id3, batch[0].getId());
+    })
+}
+
+TEST(Batch, BatchEngineShouldReduceEveryRequest) {
+    ASSERT_DURATION_LE(1, {
+        auto cm = std::make_shared<ComputationManager>(100);
+        std::vector<double> expected;
+        for (int i = 0; i < 50; ++i) {
+            Computation c(i % 2 ? ComputationType::B : ComputationType::A);
+            c.data->assign(i % 7, 2.0);
+            cm->requestComputation(c);
+            expected.push_back(i % 2 ? std::pow(2.0, i % 7) : 2.0 * (i % 7));
+        }
+        ComputeEngineBatch engineA(cm, ComputationType::A);
+        ComputeEngineBatch engineB(cm, ComputationType::B);
+        engineA.startThread();
+        engineB.startThread();
+        for (double value : expected) {
+            ASSERT_EQ(value, cm->getNextResult().getResult());
+        }
+        cm->stop();
+        engineA.join();
+        engineB.join();
+    })
+}
+
+TEST(Plugins, PluginKernelShouldCompute) {
+    ASSERT_DURATION_LE(1, {
+        auto type = KernelRegistry::instance().loadPlugin(TEST_KERNEL_PLUGIN);
+        ASSERT_EQ(type, KernelRegistry::instance().loadPlugin(TEST_KERNEL_PLUGIN)) << "Loading a plugin twice should give the same type";
+        ASSERT_EQ(type, KernelRegistry::instance().typeFromName("SumOfSquares"));
+
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEnginePlugin engine(cm, type, KernelRegistry::instance().find(type));
+        engine.startThread();
+
+        Computation c(type);
+        c.data->resize(10);
+        std::iota(c.data->begin(), c.data->end(), 1);
+        auto id = cm->requestComputation(c);
+        auto res = cm->getNextResult();
+        ASSERT_EQ(id, res.getId());
+        ASSERT_EQ(385.0, res.getResult()) << "The kernel of the plugin should have been used";
+
+        cm->stop();
+        engine.join();
+    })
+}
+
+TEST(Plugins, InvalidPluginShouldThrow) {
+    ASSERT_THROW(KernelRegistry::instance().loadPlugin("./does_not_exist.so"), KernelRegistry::PluginException);
+}
+
+TEST(Plugins, AnotherPluginWithTheSameTypeNameShouldThrow) {
+    KernelRegistry::instance().loadPlugin(TEST_KERNEL_PLUGIN);
+    // A copy of the plugin is another shared object (another handle) providing the same type name
+    std::string copy = "./labo6_kernel_copy.so";
+    {
+        std::ifstream source(TEST_KERNEL_PLUGIN, std::ios::binary);
+        std::ofstream destination(copy, std::ios::binary);
+        destination << source.rdbuf();
+    }
+    ASSERT_THROW(KernelRegistry::instance().loadPlugin(copy), KernelRegistry::PluginException);
+    std::remove(copy.c_str());
+}
+
+TEST(Plugins, EveryPluginShouldBeLoadedAndEveryFailureReported) {
+    std::string paths = std::string("./missing1.so:") + TEST_KERNEL_PLUGIN + ":./missing2.so";
+    setenv(KernelRegistry::PLUGIN_PATH_VARIABLE, paths.c_str(), 1);
+    try {
+        KernelRegistry::instance().loadFromEnvironment();
+        FAIL() << "The missing plugins should be reported";
+    } catch (KernelRegistry::PluginException& e) {
+        std::string message = e.what();
+        ASSERT_NE(std::string::npos, message.find("missing1.so"));
+        ASSERT_NE(std::string::npos, message.find("missing2.so")) << "The plugins after a failure should be tried";
+    }
+    unsetenv(KernelRegistry::PLUGIN_PATH_VARIABLE);
+    ASSERT_NO_THROW(KernelRegistry::instance().typeFromName("SumOfSquares"));
+}
+
+TEST(Allocations, SteadyStateRequestsShouldNotAllocate) {
+    ASSERT_DURATION_LE(1, {
+        ComputationManager cm;
+        Computation c(ComputationType::A);
+        c.data->assign(16, 1.0);
+        auto roundTrip = [&]() {
+            auto id = cm.requestComputation(c);
+            auto req = cm.getWork(ComputationType::A);
+            ASSERT_TRUE(cm.continueWork(req.getId()));
+            cm.provideResult(Result(req.getId(), 16.0));
+            ASSERT_EQ(id, cm.getNextResult().getId());
+        };
+        // The pools, the conditions and the queues reach their steady state
+        for (int i = 0; i < 100; ++i) {
+            roundTrip();
+        }
+        AllocationCounter::reset();
+        AllocationCounter::enable(true);
+        for (int i = 0; i < 1000; ++i) {
+            roundTrip();
+        }
+        AllocationCounter::enable(false);
+        for (int phase = AllocationCounter::Submit; phase < AllocationCounter::PHASE_COUNT; ++phase) {
+            auto p = static_cast<AllocationCounter::Phase>(phase);
+            EXPECT_EQ(0u, AllocationCounter::count(p)) << "Allocations in the " << AllocationCounter::name(p) << " phase";
+        }
+    })
+}
+
+TEST(Residency, PooledNodesAndArenaShouldBeReused) {
+    ASSERT_DURATION_LE(1, {
+        MemoryResidency::apply(ResidencyPolicy::Targeted);
+        PoolAllocator<Request> allocator;
+        auto* node = allocator.allocate(1);
+        allocator.deallocate(node, 1);
+        ASSERT_EQ(node, allocator.allocate(1)) << "A freed node should be reused";
+        allocator.deallocate(node, 1);
+
+        auto arena = std::make_shared<PayloadArena>(4);
+        double* values = arena->allocate(3);
+        ASSERT_NE(nullptr, values);
+        ASSERT_EQ(nullptr, arena->allocate(arena->capacity())) << "The arena should not give more than its capacity";
+        std::iota(values, values + 3, 1.0);
+
+        auto cm = std::make_shared<ComputationManager>();
+        ComputeEngineA engine(cm);
+        engine.startThread();
+        Computation c(ComputationType::A);
+        c.setSegments(std::vector<DataSegment>(1, DataSegment({values, 3})), arena);
+        cm->requestComputation(c);
+        ASSERT_EQ(6.0, cm->getNextResult().getResult());
+        cm->stop();
+        engine.join();
+        MemoryResidency::apply(ResidencyPolicy::None);
+    })
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,41 @@
+// Kernel plugin used by the tests : sum of the squares of the data
+
+#include "kernelplugin.h"
+
+namespace {
+
+struct SumOfSquaresState {
+    double sum;
+};
+
+void init(void* state, size_t /*size*/) {
+    static_cast<SumOfSquaresState*>(state)->sum = 0.0;
+}
+
+void step(void* state, const double* chunk, size_t count) {
+    auto s = static_cast<SumOfSquaresState*>(state);
+    for (size_t i = 0; i < count; ++i) {
+        s->sum += chunk[i] * chunk[i];
+    }
+}
+
+double finish(const void* state) {
+    return static_cast<const SumOfSquaresState*>(state)->sum;
+}
+
+const Labo6KernelDescriptor descriptor = {
+    LABO6_KERNEL_ABI_VERSION,
+    "SumOfSquares",
+    sizeof(SumOfSquaresState),
+    4,
+    1,
+    init,
+    step,
+    finish
+};
+
+}
+
+extern "C" const Labo6KernelDescriptor* labo6_kernel_descriptor() {
+    return &descriptor;
+}
@@ -0,0 +1,28 @@
+/**
+\file allocationcounter.cpp
+\author agent
+\date 19.10.2026
+
+Ce fichier contient l'implémentation de la classe AllocationCounter.
+*/
+
+#include "allocationcounter.h"
+
+std::atomic<bool> AllocationCounter::enabled{false};
+std::array<std::atomic<uint64_t>, AllocationCounter::PHASE_COUNT> AllocationCounter::counts{};
+thread_local AllocationCounter::Phase AllocationCounter::currentPhase = AllocationCounter::Other;
+
+const char *AllocationCounter::name(Phase phase) {
+   switch (phase) {
+      case Submit:
+         return "submit";
+      case Dispatch:
+         return "dispatch";
+      case Completion:
+         return "completion";
+      case Delivery:
+         return "delivery";
+      default:
+         return "other";
+   }
+}
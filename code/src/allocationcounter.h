@@ -0,0 +1,96 @@
+/**
+\file allocationcounter.h
+\author agent
+\date 19.10.2026
+
+Ce fichier contient la classe AllocationCounter qui compte les allocations sur le tas par phase du traitement d'une
+requête (soumission, distribution, fin du calcul, livraison). Le compteur est alimenté par un remplacement de
+l'opérateur new (voir labo6_tests/src/allocationhook.cpp) et permet de vérifier qu'en régime établi le chemin
+principal n'alloue plus.
+*/
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief The AllocationCounter class counts the heap allocations made in each phase of the handling of a request
+ */
+class AllocationCounter {
+public:
+   /**
+    * @brief The Phase enum lists the phases the allocations are attributed to
+    */
+   enum Phase {
+      // Anything outside of the computation manager
+      Other,
+      // requestComputation
+      Submit,
+      // getWork, getWorkBatch and continueWork
+      Dispatch,
+      // provideResult and provideResults
+      Completion,
+      // getNextResult
+      Delivery,
+      PHASE_COUNT
+   };
+
+   /**
+    * @brief The Scope class attributes the allocations of the calling thread to a phase while it exists
+    */
+   class Scope {
+   public:
+      explicit Scope(Phase phase) : previous(currentPhase) { currentPhase = phase; }
+
+      ~Scope() { currentPhase = previous; }
+
+      Scope(const Scope &) = delete;
+      Scope &operator=(const Scope &) = delete;
+
+   private:
+      Phase previous;
+   };
+
+   /**
+    * @brief record Counts an allocation in the phase of the calling thread (called by the allocation hook)
+    */
+   static void record() {
+      if (enabled.load(std::memory_order_relaxed)) {
+         counts[currentPhase].fetch_add(1, std::memory_order_relaxed);
+      }
+   }
+
+   /**
+    * @brief enable Starts or stops counting
+    */
+   static void enable(bool enable) { enabled = enable; }
+
+   /**
+    * @brief reset Sets every count back to zero
+    */
+   static void reset() {
+      for (auto &count: counts) {
+         count = 0;
+      }
+   }
+
+   /**
+    * @brief count Returns the number of allocations counted in a phase
+    */
+   static uint64_t count(Phase phase) { return counts[phase]; }
+
+   /**
+    * @brief name Returns the name of a phase
+    */
+   static const char *name(Phase phase);
+
+private:
+   static std::atomic<bool> enabled;
+   static std::array<std::atomic<uint64_t>, PHASE_COUNT> counts;
+   static thread_local Phase currentPhase;
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -10,15 +10,51 @@ et est implémentée sous la forme d'un moniteur de Hoare.
 
 #include "computationmanager.h"
 #include <algorithm>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
 
 ComputationManager::ComputationManager(int maxQueueSize) : MAX_TOLERATED_QUEUE_SIZE(maxQueueSize), stopped(false) {
 }
 
-int ComputationManager::nextId = 0;
-
-int ComputationManager::requestComputation(Computation c) {
-   auto type = static_cast<size_t>(c.computationType);
+RequestId ComputationManager::requestComputation(Computation c) {
+   AllocationCounter::Scope scope(AllocationCounter::Submit);
+   auto type = c.computationType;
+   Payload payload = c.payload();
    monitorIn();
+   // A draining buffer does not accept new requests
+   if (draining) {
+      monitorOut();
+      throwStopException();
+   }
+   // An identical request that is still pending does not need a queue slot
+   bool coalesce = coalescing;
+   size_t hash = 0;
+   if (coalesce) {
+      if (auto attachedId = attachToSharedExecution(payload, type, hash)) {
+         monitorOut();
+         return *attachedId;
+      }
+      // The monitor was left to compare the data
+      if (draining) {
+         monitorOut();
+         throwStopException();
+      }
+   }
+   // A large request that is not coalesced may be split between several compute engines. The partitioner is copied
+   // in the monitor (it may be replaced meanwhile), the job (and its buffers) is prepared outside of it.
+   std::shared_ptr<PartitionedJob> job;
+   auto partitioner = partitioners.find(type);
+   if (partitioner != partitioners.end() && partitioner->second) {
+      Partitioner partition = partitioner->second;
+      monitorOut();
+      job = partition(payload, c.parameters);
+      monitorIn();
+      if (draining) {
+         monitorOut();
+         throwStopException();
+      }
+   }
    // If the queue is full for computationType, we wait
    if (buffer[c.computationType].size() >= MAX_TOLERATED_QUEUE_SIZE) {
       if (stopped) {
@@ -26,61 +62,204 @@ int ComputationManager::requestComputation(Computation c) {
          throwStopException();
       }
       wait(fullQueuePerType[type]);
-      if (stopped) {
+      if (stopped || draining) {
          signal(fullQueuePerType[type]);
          monitorOut();
          throwStopException();
       }
    }
-   int id = nextId;
-   Request req(c, nextId++);
-   buffer[c.computationType].push_front(req);
-   results.emplace_front(req.getId(), std::nullopt);
-   signal(emptyQueuePerType[type]);
+   RequestId id = newId();
+   if (id == NO_REQUEST) {
+      monitorOut();
+      throw std::length_error("ComputationManager : no id left (too many results not delivered or ids exhausted)");
+   }
+   Request req(c, id);
+   addResult(id, type, req.payload.size());
+   if (coalesce) {
+      sharedExecutions.emplace(hash, req);
+      attachedIds[id].push_back(id);
+   }
+   if (job) {
+      auto &execution = partitionedExecutions.emplace(id, PartitionedExecution{req, job, 0}).first->second;
+      queueParts(execution);
+   } else {
+      buffer[c.computationType].push_front(req);
+      announceWork(type);
+   }
    monitorOut();
    return id;
 }
 
-void ComputationManager::abortComputation(int id) {
-
+RequestId ComputationManager::requestGroup(const std::vector<Computation> &computations, Aggregator aggregator) {
+   AllocationCounter::Scope scope(AllocationCounter::Submit);
+   size_t size = 0;
+   for (const auto &c: computations) {
+      size += c.payload().size();
+   }
    monitorIn();
-   // We look for the request in the buffer containing the pending computations and delete it if we find it
-   for (auto &list: buffer) {
-      auto it = std::find_if(list.second.begin(), list.second.end(),
-                             [&](const auto &request) { return request.getId() == id; });
-      auto type = static_cast<size_t>(list.first);
-      // If the request is found, we delete it
-      if (it != list.second.end()) {
-         list.second.erase(it);
-         signal(fullQueuePerType[type]);
+   if (draining) {
+      monitorOut();
+      throwStopException();
+   }
+   // The group takes a single place in the delivery order, before its computations are queued
+   RequestId id = newId();
+   if (id == NO_REQUEST) {
+      monitorOut();
+      throw std::length_error("ComputationManager : no id left (too many results not delivered or ids exhausted)");
+   }
+   // The type and the size only explain a stall of the delivery : a mixed group is reported with the type of its
+   // first computation and the elements of all of them
+   auto type = computations.empty() ? ComputationType::A : computations.front().computationType;
+   addResult(id, type, size);
+   double initial = aggregator.initial;
+   auto group = groups.emplace(id, Group{std::move(aggregator), initial, computations.size(), {}}).first;
+   group->second.members.reserve(computations.size());
+   if (computations.empty()) {
+      setResult(results.begin(), Result(id, initial));
+      groups.erase(group);
+      signal(notExpectedResult);
+      monitorOut();
+      return id;
+   }
+   for (const auto &c: computations) {
+      // If the queue is full for the type of the computation, we wait like for a single request
+      if (buffer[c.computationType].size() >= MAX_TOLERATED_QUEUE_SIZE) {
+         if (!stopped) {
+            wait(fullQueuePerType[c.computationType]);
+            if (stopped || draining) {
+               signal(fullQueuePerType[c.computationType]);
+            }
+         }
+         // The computations already queued are removed with the group
+         if (stopped || draining) {
+            abortLocked(id);
+            monitorOut();
+            throwStopException();
+         }
+      }
+      // The group may have been aborted while we waited, its entries are looked up again
+      auto entry = findResult(id);
+      group = groups.find(id);
+      if (entry == results.end() || group == groups.end()) {
+         // The space we were signalled goes to the next client waiting for it
+         signal(fullQueuePerType[c.computationType]);
          monitorOut();
+         return id;
+      }
+      RequestId member = newId();
+      if (member == NO_REQUEST) {
+         abortLocked(id);
+         monitorOut();
+         throw std::length_error("ComputationManager : no id left (too many results not delivered or ids exhausted)");
+      }
+      // The slot of the computation leads to the result of the group
+      slots[member & (MAX_PENDING_IDS - 1)].result = entry;
+      group->second.members.push_back(member);
+      buffer[c.computationType].push_front(Request(c, member));
+      announceWork(c.computationType);
+   }
+   monitorOut();
+   return id;
+}
+
+void ComputationManager::abortComputation(RequestId id) {
+   monitorIn();
+   abortLocked(id);
+   monitorOut();
+}
+
+void ComputationManager::abortLocked(RequestId id) {
+   // A stale id (delivered, aborted or from another buffer) has nothing left to abort, the computations of a group
+   // are aborted with the group only
+   auto it = findResult(id);
+   if (it == results.end() || it->id != id) {
+      return;
+   }
+   // If the id shares its execution with other ids, the execution goes on for them
+   RequestId executionId = id;
+   bool executionStillWanted = false;
+   for (auto &execution: attachedIds) {
+      auto &ids = execution.second;
+      auto attached = std::find(ids.begin(), ids.end(), id);
+      if (attached != ids.end()) {
+         ids.erase(attached);
+         if (ids.empty()) {
+            // Nobody wants the result anymore, the execution itself is aborted below
+            executionId = execution.first;
+            releaseSharedExecution(executionId);
+         } else {
+            executionStillWanted = true;
+         }
          break;
       }
    }
 
-   // We check if the request is in the results (i.e. being computed or computed)
-   auto it = std::find_if(results.begin(), results.end(),
-                          [&](const auto &resultWithId) { return resultWithId.id == id; });
-   if (it != results.end()) {
-      // If it is a result being computed, we signal to unblock the thread that is potentially waiting for it
-      if (!it->result.has_value()) {
-         signal(notExpectedResult);
+   // We look for the request (or its parts) in the buffer containing the pending computations and delete it
+   std::map<ComputationType, size_t> freed;
+   if (!executionStillWanted) {
+      partitionedExecutions.erase(executionId);
+      // A bulk request keeps its place until its engine stops streaming
+      abortBulk(executionId);
+      // The computations of a group lead to the result of the group
+      auto group = groups.find(id);
+      if (group != groups.end()) {
+         for (RequestId member: group->second.members) {
+            abortBulk(member);
+         }
+      }
+      for (auto &list: buffer) {
+         auto removed = list.second.size();
+         list.second.remove_if([&](const auto &request) {
+            return request.getId() == executionId || (group != groups.end() && findResult(request.getId()) == it);
+         });
+         if (removed > list.second.size()) {
+            freed[list.first] = removed - list.second.size();
+         }
       }
-      results.erase(it);
-      monitorOut();
-      return;
    }
-   monitorOut();
+
+   bool computing = !it->result.has_value();
+   eraseResult(it);
+   trackHeadOfLine();
+   // Every removed request frees a slot in the queue. The waiting clients are signalled once the id is gone : a group
+   // waiting for space must see that it was aborted.
+   for (auto &queue: freed) {
+      for (; queue.second > 0; --queue.second) {
+         signal(fullQueuePerType[queue.first]);
+      }
+   }
+   // If it is a result being computed, we signal to unblock the thread that is potentially waiting for it
+   if (computing) {
+      signal(notExpectedResult);
+   }
 }
 
 Result ComputationManager::getNextResult() {
+   AllocationCounter::Scope scope(AllocationCounter::Delivery);
    monitorIn();
-   // If there isn't any result or the result is not the one we are waiting for, we wait
-   while (results.empty() or !results.back().result.has_value()) {
-      if (stopped) {
+   // If there isn't any result or the result is not one we can deliver yet, we wait
+   ResultList::iterator next;
+   while ((next = nextDeliverable()) == results.end()) {
+      // A drained buffer has no result to come anymore
+      if (stopped || (draining && results.empty())) {
          monitorOut();
          throwStopException();
       }
+      // Instead of waiting, the consumer may execute a queued request itself
+      if (consumerAssist) {
+         if (auto request = takeAssistWork()) {
+            // The executor is copied, it may be replaced while it runs outside of the monitor
+            InlineExecutor executor = inlineExecutors[request->getComputationType()];
+            monitorOut();
+            double value = executor(request->payload);
+            monitorIn();
+            // Another consumer may be waiting for this result
+            if (storeResult(Result(request->getId(), value))) {
+               signal(notExpectedResult);
+            }
+            continue;
+         }
+      }
       wait(notExpectedResult);
       if (stopped) {
          signal(notExpectedResult);
@@ -89,74 +268,815 @@ Result ComputationManager::getNextResult() {
       }
    }
 
-   Result result = results.back().result.value();
-   results.pop_back();
+   Result result = next->result.value();
+   eraseResult(next);
+   trackHeadOfLine();
+   // The periodic report is given to the reporter by the consumer, outside of the monitor
+   std::string report;
+   if (headOfLineReporter && std::chrono::steady_clock::now() - lastHeadOfLineReport >= headOfLineReportPeriod) {
+      lastHeadOfLineReport = std::chrono::steady_clock::now();
+      report = headOfLineReportLocked(REPORTED_STALLS);
+   }
+   auto reporter = report.empty() ? nullptr : headOfLineReporter;
    monitorOut();
+   if (reporter) {
+      reporter(report);
+   }
    return result;
 }
 
 Request ComputationManager::getWork(ComputationType computationType) {
-   auto type = static_cast<size_t>(computationType);
+   AllocationCounter::Scope scope(AllocationCounter::Dispatch);
    monitorIn();
-   // If there isn't any request of the right type in the buffer, we wait
-   if (buffer[computationType].empty()) {
-      if (stopped) {
-         monitorOut();
-         throwStopException();
-      }
-      wait(emptyQueuePerType[type]);
-      if (stopped) {
-         signal(emptyQueuePerType[type]);
-         monitorOut();
-         throwStopException();
-      }
+   waitForWork(computationType);
+   Request newReq = takeWork(computationType);
+   monitorOut();
+   return newReq;
+}
+
+std::optional<Request> ComputationManager::tryGetWork(ComputationType computationType) {
+   AllocationCounter::Scope scope(AllocationCounter::Dispatch);
+   monitorIn();
+   if (stopped || !hasDispatchable(buffer[computationType])) {
+      monitorOut();
+      return std::nullopt;
    }
-   Request newReq = buffer[computationType].back();
-   buffer[computationType].pop_back();
-   signal(fullQueuePerType[type]);
+   std::optional<Request> newReq = takeWork(computationType);
    monitorOut();
    return newReq;
 }
 
-bool ComputationManager::continueWork(int id) {
+Request ComputationManager::takeWork(ComputationType type) {
+   auto selected = selectWork(buffer[type]);
+   if (cacheAffinity) {
+      recordTouch(selected->payload);
+   }
+   if (isBulk(*selected)) {
+      startBulk(*selected);
+   }
+   Request newReq = *selected;
+   buffer[type].erase(selected);
+   signal(fullQueuePerType[type]);
+   return newReq;
+}
+
+void ComputationManager::getWorkBatch(ComputationType computationType, std::vector<Request> &batch, size_t maxRequests,
+                                      size_t maxElements) {
+   AllocationCounter::Scope scope(AllocationCounter::Dispatch);
+   batch.clear();
+   monitorIn();
+   waitForWork(computationType);
+   takeWorkBatch(computationType, batch, maxRequests, maxElements);
+   monitorOut();
+}
+
+bool ComputationManager::tryGetWorkBatch(ComputationType computationType, std::vector<Request> &batch,
+                                         size_t maxRequests, size_t maxElements) {
+   AllocationCounter::Scope scope(AllocationCounter::Dispatch);
+   batch.clear();
+   monitorIn();
+   if (stopped || !hasDispatchable(buffer[computationType])) {
+      monitorOut();
+      return false;
+   }
+   takeWorkBatch(computationType, batch, maxRequests, maxElements);
+   monitorOut();
+   return true;
+}
+
+void ComputationManager::takeWorkBatch(ComputationType type, std::vector<Request> &batch, size_t maxRequests,
+                                       size_t maxElements) {
+   auto &queue = buffer[type];
+   auto selected = selectWork(queue);
+   if (cacheAffinity) {
+      recordTouch(selected->payload);
+   }
+   if (isBulk(*selected)) {
+      startBulk(*selected);
+   }
+   bool small = !selected->job && selected->payload.size() <= maxElements;
+   batch.push_back(*selected);
+   queue.erase(selected);
+   // The other small requests of the queue are taken with it, from the oldest
+   if (small) {
+      for (auto it = queue.end(); it != queue.begin() && batch.size() < maxRequests;) {
+         --it;
+         if (!it->job && it->payload.size() <= maxElements) {
+            batch.push_back(*it);
+            it = queue.erase(it);
+         }
+      }
+   }
+   for (size_t i = 0; i < batch.size(); ++i) {
+      signal(fullQueuePerType[type]);
+   }
+}
+
+bool ComputationManager::continueWork(RequestId id) {
+   AllocationCounter::Scope scope(AllocationCounter::Dispatch);
    monitorIn();
    if (stopped) {
       monitorOut();
       return false;
    }
 
+   // A shared execution goes on as long as one of its ids is still wanted
+   if (attachedIds.count(id)) {
+      monitorOut();
+      return true;
+   }
+
    // We check if the result is in the results (i.e. being computed or computed)
-   auto it = std::find_if(results.begin(), results.end(),
-                          [&](const auto &pairIdResult) { return pairIdResult.id == id; });
+   bool wanted = findResult(id) != results.end();
+   // The engine of an aborted bulk request stops streaming now, it frees its place
+   if (!wanted && !bulkExecutions.empty()) {
+      finishBulk(id, false);
+   }
 
    monitorOut();
-   return !(it == results.end());
+   return wanted;
 }
 
 void ComputationManager::provideResult(Result result) {
+   AllocationCounter::Scope scope(AllocationCounter::Completion);
    monitorIn();
-   auto it = std::find_if(results.begin(), results.end(),
-                          [&](const auto &resultChecked) { return resultChecked.id == result.getId(); });
-   if (it == results.end()) {
-      monitorOut();
-      return;
+   if (storeResult(std::move(result))) {
+      signal(notExpectedResult);
    }
-   it->result = result;
-   signal(notExpectedResult);
    monitorOut();
 }
 
+void ComputationManager::provideResults(const std::vector<Result> &batch) {
+   AllocationCounter::Scope scope(AllocationCounter::Completion);
+   monitorIn();
+   // A single signal for the whole batch
+   bool stored = false;
+   for (const auto &result: batch) {
+      stored = storeResult(result) || stored;
+   }
+   if (stored) {
+      signal(notExpectedResult);
+   }
+   monitorOut();
+}
+
+bool ComputationManager::storeResult(Result result) {
+   if (!bulkExecutions.empty()) {
+      finishBulk(result.getId(), true);
+   }
+   // The parts of a partitioned request are combined when all of them are done
+   auto partitioned = partitionedExecutions.find(result.getId());
+   if (partitioned != partitionedExecutions.end()) {
+      auto &execution = partitioned->second;
+      if (--execution.remainingParts > 0) {
+         return false;
+      }
+      if (execution.job->nextPhase()) {
+         queueParts(execution);
+         return false;
+      }
+      result = execution.job->result(result.getId());
+      partitionedExecutions.erase(partitioned);
+   }
+   // The result of a shared execution goes to every id attached to it
+   auto execution = attachedIds.find(result.getId());
+   if (execution != attachedIds.end()) {
+      std::vector<RequestId> ids = std::move(execution->second);
+      releaseSharedExecution(result.getId());
+      for (RequestId id: ids) {
+         auto it = findResult(id);
+         if (it != results.end()) {
+            setResult(it, Result(id, result.getResult(), result.getValues()));
+         }
+      }
+      trackHeadOfLine();
+      return true;
+   }
+   auto it = findResult(result.getId());
+   if (it == results.end()) {
+      return false;
+   }
+   if (it->id != result.getId()) {
+      return combineGroupResult(it, result);
+   }
+   setResult(it, std::move(result));
+   trackHeadOfLine();
+   return true;
+}
+
+void ComputationManager::waitForWork(ComputationType type) {
+   // If there isn't any request of the right type in the buffer (that can be dispatched now), we wait
+   while (!hasDispatchable(buffer[type])) {
+      if (stopped) {
+         monitorOut();
+         throwStopException();
+      }
+      wait(emptyQueuePerType[type]);
+      if (stopped) {
+         signal(emptyQueuePerType[type]);
+         monitorOut();
+         throwStopException();
+      }
+   }
+}
+
 void ComputationManager::stop() {
 
    monitorIn();
    stopped = true;
+   notifyDrain();
    // We signal on every existing condition to unblock waiting threads
    signal(notExpectedResult);
    for (auto &condition: emptyQueuePerType) {
-      signal(condition);
+      signal(condition.second);
+   }
+   for (auto &condition: fullQueuePerType) {
+      signal(condition.second);
+   }
+   monitorOut();
+}
+
+std::map<RequestId, HandedBackRequest> ComputationManager::drain(std::chrono::milliseconds deadline) {
+   auto limit = std::chrono::steady_clock::now() + deadline;
+   std::map<RequestId, HandedBackRequest> neverStarted;
+
+   monitorIn();
+   draining = true;
+   {
+      std::lock_guard<std::mutex> lock(drainMutex);
+      drainOver = false;
+   }
+   // The executions that have not started, by the id they were queued with
+   std::map<RequestId, Computation> notStarted;
+   // The partitioned requests whose parts of the first phase are all still queued have not started
+   for (auto &partitioned: partitionedExecutions) {
+      const auto &execution = partitioned.second;
+      const auto &queue = buffer[execution.request.getComputationType()];
+      auto queued = std::count_if(queue.begin(), queue.end(),
+                                  [&](const auto &request) { return request.getId() == partitioned.first; });
+      if (execution.job->getPhase() == 0 && static_cast<size_t>(queued) == execution.job->phaseParts().size()) {
+         notStarted.emplace(partitioned.first, execution.request.toComputation());
+      }
+   }
+   for (const auto &execution: notStarted) {
+      partitionedExecutions.erase(execution.first);
+   }
+   // A group none of whose computations was dispatched is handed back whole, with its aggregator. A group with a
+   // computation dispatched (or completed) has started, it is left to finish.
+   for (const auto &group: groups) {
+      const auto &members = group.second.members;
+      if (members.size() != group.second.remaining) {
+         continue;
+      }
+      std::map<RequestId, Computation> queued;
+      for (const auto &list: buffer) {
+         for (const auto &request: list.second) {
+            auto owner = findResult(request.getId());
+            if (owner != results.end() && owner->id == group.first && request.getId() != group.first) {
+               queued.emplace(request.getId(), request.toComputation());
+            }
+         }
+      }
+      if (queued.size() == members.size()) {
+         HandedBackRequest handedBack{{}, group.second.aggregator};
+         for (RequestId member: members) {
+            handedBack.computations.push_back(queued.at(member));
+         }
+         neverStarted.emplace(group.first, std::move(handedBack));
+      }
    }
+   // Every other queued request is handed back, its result will never come
+   for (auto &list: buffer) {
+      for (const auto &request: list.second) {
+         auto owner = findResult(request.getId());
+         if (!request.job && (owner == results.end() || owner->id == request.getId())) {
+            notStarted.emplace(request.getId(), request.toComputation());
+         }
+      }
+      list.second.remove_if([&](const auto &request) {
+         auto owner = findResult(request.getId());
+         return notStarted.count(request.getId()) > 0 || (owner != results.end() && neverStarted.count(owner->id) > 0);
+      });
+   }
+   // The live ids of an execution are handed back : its own id unless it was aborted, and the ids attached to it
+   for (const auto &execution: notStarted) {
+      if (findResult(execution.first) != results.end()) {
+         neverStarted.emplace(execution.first, HandedBackRequest{{execution.second}, std::nullopt});
+      }
+      auto attached = attachedIds.find(execution.first);
+      if (attached != attachedIds.end()) {
+         for (RequestId id: attached->second) {
+            neverStarted.emplace(id, HandedBackRequest{{execution.second}, std::nullopt});
+         }
+      }
+      releaseSharedExecution(execution.first);
+   }
+   for (const auto &handedBack: neverStarted) {
+      auto it = findResult(handedBack.first);
+      if (it != results.end()) {
+         eraseResult(it);
+      }
+   }
+   trackHeadOfLine();
+   notifyDrain();
+   // The clients waiting on a full queue or for a result that will never come are released
    for (auto &condition: fullQueuePerType) {
-      signal(condition);
+      signal(condition.second);
+   }
+   signal(notExpectedResult);
+   monitorOut();
+
+   // The running requests are given until the deadline to finish and be delivered
+   {
+      std::unique_lock<std::mutex> lock(drainMutex);
+      drainDone.wait_until(lock, limit, [this]() { return drainOver; });
+   }
+   stop();
+   return neverStarted;
+}
+
+void ComputationManager::setPartitioner(ComputationType computationType, Partitioner partitioner) {
+   monitorIn();
+   partitioners[computationType] = std::move(partitioner);
+   monitorOut();
+}
+
+void ComputationManager::queueParts(PartitionedExecution &execution) {
+   auto type = execution.request.getComputationType();
+   auto parts = execution.job->phaseParts();
+   execution.remainingParts = parts.size();
+   for (unsigned part: parts) {
+      buffer[type].push_front(Request(execution.request, execution.job, part));
+      announceWork(type);
+   }
+}
+
+void ComputationManager::setHeadOfLineWindow(size_t window) {
+   monitorIn();
+   headOfLineWindow = window;
+   monitorOut();
+}
+
+void ComputationManager::setReorderingTolerance(size_t tolerance) {
+   monitorIn();
+   reorderingTolerance = tolerance;
+   // A result already ready may be deliverable now
+   signal(notExpectedResult);
+   monitorOut();
+}
+
+ComputationManager::ResultList::iterator ComputationManager::nextDeliverable() {
+   // The head is at the back of the results, the results within the tolerance are the k ones right before it. They
+   // are counted by position : the aborted ids and the computations of a group leave gaps in the ids.
+   size_t position = 0;
+   for (auto it = results.rbegin(); it != results.rend() && position <= reorderingTolerance; ++it, ++position) {
+      if (it->result.has_value()) {
+         return std::prev(it.base());
+      }
+   }
+   return results.end();
+}
+
+ComputationManager::RequestQueue::iterator ComputationManager::selectWork(RequestQueue &queue) {
+   // The oldest request is at the back of the queue
+   auto oldest = oldestDispatchable(queue);
+   if (headOfLineWindow == 0 || results.empty()) {
+      return cacheAffinity ? selectAffineWork(queue) : oldest;
+   }
+   // The requests close to the delivery head are the ones getNextResult is blocked on, they go first.
+   // An execution shared with the head has a smaller id than the head, it is in the window too.
+   // The computations of a group are as close to the head as the group.
+   RequestId head = results.back().id;
+   for (auto it = queue.rbegin(); it != queue.rend(); ++it) {
+      auto owner = findResult(it->getId());
+      RequestId id = owner == results.end() ? it->getId() : owner->id;
+      if ((id < head || sequence(id) - sequence(head) < headOfLineWindow) && dispatchable(*it)) {
+         return std::prev(it.base());
+      }
+   }
+   return cacheAffinity ? selectAffineWork(queue) : oldest;
+}
+
+ComputationManager::RequestQueue::iterator ComputationManager::selectAffineWork(RequestQueue &queue) {
+   auto oldest = oldestDispatchable(queue);
+   int cpu = sched_getcpu();
+   if (cpu < 0) {
+      return oldest;
+   }
+   // Among the oldest requests, the one whose data was last touched on this CPU is still in its caches
+   size_t considered = 0;
+   for (auto it = queue.rbegin(); it != queue.rend() && considered < AFFINITY_WINDOW; ++it, ++considered) {
+      const void *key = bufferKey(it->payload);
+      if (key == nullptr || !dispatchable(*it)) {
+         continue;
+      }
+      for (const auto &touch: recentTouches) {
+         if (touch.buffer == key && touch.cpu == cpu) {
+            return std::prev(it.base());
+         }
+      }
+   }
+   return oldest;
+}
+
+void ComputationManager::recordTouch(const Payload &payload) {
+   const void *key = bufferKey(payload);
+   int cpu = sched_getcpu();
+   if (key == nullptr || cpu < 0) {
+      return;
+   }
+   // The buffer keeps a single entry, the CPU that touched it last
+   for (auto &touch: recentTouches) {
+      if (touch.buffer == key) {
+         touch.cpu = cpu;
+         return;
+      }
+   }
+   recentTouches[nextTouch] = {key, cpu};
+   nextTouch = (nextTouch + 1) % recentTouches.size();
+}
+
+const void *ComputationManager::bufferKey(const Payload &payload) {
+   if (payload.getPacked()) {
+      return payload.getPacked().get();
+   }
+   auto segments = payload.getSegments();
+   return segments.empty() ? nullptr : segments[0].data;
+}
+
+bool ComputationManager::isBulk(const Request &request) const {
+   auto type = request.getComputationType();
+   return bandwidthGovernor && (type == ComputationType::A || type == ComputationType::B) && !request.job &&
+          request.payload.size() * sizeof(double) >= BULK_MIN_BYTES;
+}
+
+bool ComputationManager::dispatchable(const Request &request) const {
+   return bulkExecutions.size() < bulkLimit || !isBulk(request);
+}
+
+bool ComputationManager::hasDispatchable(const RequestQueue &queue) const {
+   return std::any_of(queue.begin(), queue.end(), [this](const auto &request) { return dispatchable(request); });
+}
+
+ComputationManager::RequestQueue::iterator ComputationManager::oldestDispatchable(RequestQueue &queue) {
+   for (auto it = queue.rbegin(); it != queue.rend(); ++it) {
+      if (dispatchable(*it)) {
+         return std::prev(it.base());
+      }
+   }
+   return std::prev(queue.end());
+}
+
+void ComputationManager::startBulk(const Request &request) {
+   bulkExecutions[request.getId()] = {request.payload.size() * sizeof(double), std::chrono::steady_clock::now(),
+                                      bulkExecutions.size() + 1, false};
+}
+
+void ComputationManager::abortBulk(RequestId id) {
+   auto it = bulkExecutions.find(id);
+   if (it != bulkExecutions.end()) {
+      it->second.aborted = true;
+   }
+}
+
+void ComputationManager::finishBulk(RequestId id, bool completed) {
+   auto it = bulkExecutions.find(id);
+   if (it == bulkExecutions.end()) {
+      return;
+   }
+   if (completed && !it->second.aborted) {
+      // The bandwidth the memory system gives to all of the bulk requests together, at this concurrency
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - it->second.start;
+      double aggregate = static_cast<double>(it->second.bytes) / std::max(elapsed.count(), 1e-9) *
+                         static_cast<double>(it->second.concurrency);
+      double &measured = bandwidthAt[std::min(it->second.concurrency, MAX_BULK_LIMIT)];
+      measured = measured == 0.0 ? aggregate : 0.7 * measured + 0.3 * aggregate;
+      // One more concurrent request is tried as long as it pays, else the best concurrency measured is used
+      size_t best = 1;
+      for (size_t concurrency = 1; concurrency <= MAX_BULK_LIMIT; ++concurrency) {
+         if (bandwidthAt[concurrency] > bandwidthAt[best]) {
+            best = concurrency;
+         }
+      }
+      if (best == bulkLimit && bulkLimit < MAX_BULK_LIMIT) {
+         ++bulkLimit;
+      } else if (bandwidthAt[bulkLimit] < 0.95 * bandwidthAt[best]) {
+         bulkLimit = best;
+      }
+   }
+   bulkExecutions.erase(it);
+   // A waiting streaming engine may take a bulk request now
+   announceWork(ComputationType::A);
+   announceWork(ComputationType::B);
+}
+
+void ComputationManager::setBandwidthGovernor(bool enabled) {
+   monitorIn();
+   bandwidthGovernor = enabled;
+   monitorOut();
+}
+
+size_t ComputationManager::getBulkLimit() {
+   monitorIn();
+   size_t limit = bulkLimit;
+   monitorOut();
+   return limit;
+}
+
+void ComputationManager::trackHeadOfLine() {
+   // Nobody reads the stretches, they are not tracked
+   if (!headOfLineReporter) {
+      return;
+   }
+   bool headReady = !results.empty() && results.back().result.has_value();
+   // The stretch ends when the blocking head is ready or gone
+   if (stallHead != NO_REQUEST && (results.empty() || results.back().id != stallHead || headReady)) {
+      // The results ready behind the head, the head itself is not counted if it is still there
+      auto head = findResult(stallHead);
+      size_t piledUp = readyResults - (head != results.end() && head->result.has_value() ? 1 : 0);
+      HeadOfLineStall stall{stallHead, stallType, stallSize,
+                            std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - stallStart), piledUp};
+      ++stallCount;
+      totalStallTime += stall.duration;
+      // Only the worst stretches are kept, sorted from the worst
+      auto position = std::find_if(worstStalls.begin(), worstStalls.end(),
+                                   [&](const auto &kept) { return kept.duration < stall.duration; });
+      if (worstStalls.size() < MAX_KEPT_STALLS || position != worstStalls.end()) {
+         worstStalls.insert(position, stall);
+         if (worstStalls.size() > MAX_KEPT_STALLS) {
+            worstStalls.pop_back();
+         }
+      }
+      stallHead = NO_REQUEST;
+   }
+   // A stretch starts when a result is ready behind a head that is not
+   if (stallHead == NO_REQUEST && !results.empty() && !headReady && readyResults > 0) {
+      stallHead = results.back().id;
+      stallType = results.back().type;
+      stallSize = results.back().size;
+      stallStart = std::chrono::steady_clock::now();
+   }
+}
+
+std::vector<ComputationManager::HeadOfLineStall> ComputationManager::getWorstStalls(size_t count) {
+   monitorIn();
+   std::vector<HeadOfLineStall> worst(worstStalls.begin(), worstStalls.begin() + std::min(count, worstStalls.size()));
+   monitorOut();
+   return worst;
+}
+
+std::string ComputationManager::headOfLineReport(size_t count) {
+   monitorIn();
+   std::string report = headOfLineReportLocked(count);
+   monitorOut();
+   return report;
+}
+
+std::string ComputationManager::headOfLineReportLocked(size_t count) const {
+   std::ostringstream report;
+   report << "Head-of-line blocking : " << stallCount << " stretches, " << totalStallTime.count() / 1000 << " ms in total";
+   for (size_t i = 0; i < std::min(count, worstStalls.size()); ++i) {
+      const auto &stall = worstStalls[i];
+      report << "\n  request " << stall.id << " (type " << static_cast<int>(stall.type) << ", " << stall.payloadSize
+             << " elements) blocked " << stall.duration.count() / 1000.0 << " ms, " << stall.piledUp
+             << " results behind it";
+   }
+   return report.str();
+}
+
+void ComputationManager::setHeadOfLineReporter(std::chrono::milliseconds period,
+                                               std::function<void(const std::string &)> reporter) {
+   monitorIn();
+   headOfLineReportPeriod = period;
+   headOfLineReporter = std::move(reporter);
+   lastHeadOfLineReport = std::chrono::steady_clock::now();
+   // A stretch in progress is measured from now on, or forgotten if the tracking stops
+   stallHead = NO_REQUEST;
+   trackHeadOfLine();
+   monitorOut();
+}
+
+void ComputationManager::setWorkListener(WorkListener listener) {
+   monitorIn();
+   workListener = std::move(listener);
+   monitorOut();
+}
+
+void ComputationManager::announceWork(ComputationType type) {
+   signal(emptyQueuePerType[type]);
+   if (workListener) {
+      workListener(type);
+   }
+}
+
+void ComputationManager::setCacheAffinity(bool enabled) {
+   monitorIn();
+   cacheAffinity = enabled;
+   monitorOut();
+}
+
+void ComputationManager::setRequestCoalescing(bool enabled) {
+   monitorIn();
+   coalescing = enabled;
+   monitorOut();
+}
+
+void ComputationManager::setInlineExecutor(ComputationType computationType, InlineExecutor executor) {
+   monitorIn();
+   inlineExecutors[computationType] = std::move(executor);
+   monitorOut();
+}
+
+void ComputationManager::setConsumerAssist(bool enabled) {
+   monitorIn();
+   consumerAssist = enabled;
+   monitorOut();
+}
+
+std::optional<Request> ComputationManager::takeAssistWork() {
+   RequestId head = results.empty() ? NO_REQUEST : results.back().id;
+   std::optional<RequestQueue::iterator> chosen;
+   RequestQueue *chosenQueue = nullptr;
+   for (auto &list: buffer) {
+      if (!inlineExecutors.count(list.first) || !inlineExecutors[list.first]) {
+         continue;
+      }
+      // The parts of a partitioned request are left to the engines, the bulk requests over the limit wait like for them
+      for (auto it = list.second.rbegin(); it != list.second.rend(); ++it) {
+         if (it->job || !dispatchable(*it)) {
+            continue;
+         }
+         if (it->getId() == head) {
+            chosen = std::prev(it.base());
+            chosenQueue = &list.second;
+            break;
+         }
+         // A request that is not the head must be small, so that the head is not delivered too late
+         if (!chosen && it->payload.size() <= ASSIST_MAX_ELEMENTS) {
+            chosen = std::prev(it.base());
+            chosenQueue = &list.second;
+         }
+      }
+      if (chosen && (*chosen)->getId() == head) {
+         break;
+      }
+   }
+   if (!chosen) {
+      return std::nullopt;
+   }
+   if (isBulk(**chosen)) {
+      startBulk(**chosen);
+   }
+   Request request = **chosen;
+   chosenQueue->erase(*chosen);
+   signal(fullQueuePerType[request.getComputationType()]);
+   return request;
+}
+
+size_t ComputationManager::fingerprint(const Payload &payload, ComputationType type) {
+   return payload.hash() ^ (static_cast<size_t>(type) * 0x9e3779b97f4a7c15ULL);
+}
+
+std::optional<RequestId> ComputationManager::attachToSharedExecution(const Payload &payload, ComputationType type,
+                                                                    size_t &hash) {
+   // The data is hashed outside of the monitor, it can be large
+   monitorOut();
+   hash = fingerprint(payload, type);
+   monitorIn();
+   // Every execution of the same type with this hash is a candidate, they are copied since the monitor is left to
+   // compare them
+   std::vector<Request> candidates;
+   auto range = sharedExecutions.equal_range(hash);
+   for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.getComputationType() == type) {
+         candidates.push_back(it->second);
+      }
+   }
+   if (candidates.empty()) {
+      return std::nullopt;
    }
+   // The same buffer or a buffer with exactly the same bits (a hash collision is possible, and the data of a
+   // candidate may have changed since it was hashed), compared outside of the monitor too
    monitorOut();
+   auto different = [&payload](const Request &execution) { return !execution.payload.sameContent(payload); };
+   candidates.erase(std::remove_if(candidates.begin(), candidates.end(), different), candidates.end());
+   monitorIn();
+   if (draining) {
+      return std::nullopt;
+   }
+   // The first identical execution that has not completed or been aborted meanwhile
+   auto candidate = std::find_if(candidates.begin(), candidates.end(),
+                                 [this](const Request &execution) { return attachedIds.count(execution.getId()) > 0; });
+   if (candidate == candidates.end()) {
+      return std::nullopt;
+   }
+   RequestId id = newId();
+   if (id == NO_REQUEST) {
+      return std::nullopt;
+   }
+   addResult(id, type, payload.size());
+   attachedIds[candidate->getId()].push_back(id);
+   return id;
+}
+
+void ComputationManager::releaseSharedExecution(RequestId executionId) {
+   attachedIds.erase(executionId);
+   for (auto it = sharedExecutions.begin(); it != sharedExecutions.end(); ++it) {
+      if (it->second.getId() == executionId) {
+         sharedExecutions.erase(it);
+         return;
+      }
+   }
+}
+
+RequestId ComputationManager::newId() {
+   // The sequence numbers left are checked first, a wrapped sequence would give ids already used (or NO_REQUEST)
+   if (nextSequence > MAX_SEQUENCE) {
+      return NO_REQUEST;
+   }
+   uint32_t slot;
+   if (!freeSlots.empty()) {
+      slot = freeSlots.back();
+      freeSlots.pop_back();
+   } else if (slots.size() < MAX_PENDING_IDS) {
+      slot = static_cast<uint32_t>(slots.size());
+      slots.emplace_back();
+   } else {
+      return NO_REQUEST;
+   }
+   // The sequence number tells this id apart from the previous ones of the slot
+   RequestId id = (nextSequence++ << SLOT_BITS) | slot;
+   slots[slot].id = id;
+   return id;
+}
+
+void ComputationManager::addResult(RequestId id, ComputationType type, size_t size) {
+   results.emplace_front(id, std::nullopt, type, size);
+   slots[id & (MAX_PENDING_IDS - 1)].result = results.begin();
+}
+
+ComputationManager::ResultList::iterator ComputationManager::findResult(RequestId id) {
+   size_t slot = id & (MAX_PENDING_IDS - 1);
+   if (slot >= slots.size() || slots[slot].id != id) {
+      return results.end();
+   }
+   return slots[slot].result;
+}
+
+bool ComputationManager::combineGroupResult(ResultList::iterator group, const Result &result) {
+   auto &aggregation = groups.at(group->id);
+   aggregation.value = aggregation.aggregator.combiner(aggregation.value, result.getResult());
+   // A computation gives a single result, its id becomes stale
+   size_t slot = result.getId() & (MAX_PENDING_IDS - 1);
+   slots[slot].id = NO_REQUEST;
+   freeSlots.push_back(static_cast<uint32_t>(slot));
+   if (--aggregation.remaining > 0) {
+      return false;
+   }
+   setResult(group, Result(group->id, aggregation.value));
+   groups.erase(group->id);
+   trackHeadOfLine();
+   return true;
+}
+
+void ComputationManager::eraseResult(ResultList::iterator it) {
+   // The computations of a group that did not give their result yet become stale with it
+   auto group = groups.find(it->id);
+   if (group != groups.end()) {
+      for (RequestId member: group->second.members) {
+         size_t slot = member & (MAX_PENDING_IDS - 1);
+         if (slots[slot].id == member) {
+            slots[slot].id = NO_REQUEST;
+            freeSlots.push_back(static_cast<uint32_t>(slot));
+         }
+      }
+      groups.erase(group);
+   }
+   size_t slot = it->id & (MAX_PENDING_IDS - 1);
+   slots[slot].id = NO_REQUEST;
+   freeSlots.push_back(static_cast<uint32_t>(slot));
+   if (it->result.has_value()) {
+      --readyResults;
+   }
+   results.erase(it);
+   notifyDrain();
+}
+
+void ComputationManager::notifyDrain() {
+   if (!draining || !(stopped || results.empty())) {
+      return;
+   }
+   {
+      std::lock_guard<std::mutex> lock(drainMutex);
+      drainOver = true;
+   }
+   drainDone.notify_all();
+}
+
+void ComputationManager::setResult(ResultList::iterator it, Result result) {
+   if (!it->result.has_value()) {
+      ++readyResults;
+   }
+   it->result = std::move(result);
 }
@@ -18,6 +18,18 @@ et des moteurs de calculs et qui est implémentée sous la forme d'un moniteur d
 #include <queue>
 #include <optional>
 #include <list>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+
+#include "allocationcounter.h"
+#include "memoryresidency.h"
+#include "payload.h"
 
 #include "pcosynchro/pcohoaremonitor.h"
 #include "pcosynchro/pcoconditionvariable.h"
@@ -25,11 +37,22 @@ et des moteurs de calculs et qui est implémentée sous la forme d'un moniteur d
 
 /**
  * @brief The ComputationType enum represents the abstract computation types that are available
+ * The values from KernelRegistry::FIRST_PLUGIN_TYPE are given to the kernels loaded from plugins.
  */
 enum class ComputationType {
-   A, B, C
+   A, B, C, D, E
 };
 
+/**
+ * @brief RequestId Identifies a request in the buffer that accepted it. The high bits are the sequence number of the
+ * request in this buffer (so the ids follow the order of the requests), the low bits are the index of the slot that
+ * holds the request until it is delivered or aborted. A slot is then reused by a later request, whose sequence number
+ * tells the stale ids of the slot apart. 0 is never the id of a request. A buffer gives at most 2^44 - 1 ids (about
+ * 20 days at 10 millions of requests per second), the next requests throw std::length_error.
+ */
+using RequestId = uint64_t;
+constexpr RequestId NO_REQUEST = 0;
+
 /**
  * @brief The Computation class Represents a computation with a given type and data.
  */
@@ -47,12 +70,69 @@ public:
     */
    ComputationType computationType;
    /**
-    * @brief data The data for the computation
+    * @brief data The data for the computation, kept alive by the requests and read when the computation executes
+    * (it must not be changed while it is computed)
     */
    std::shared_ptr<std::vector<double>> data;
 
+   /**
+    * @brief parameters The parameters of the computation, their meaning depends on the type (empty for most types)
+    */
+   std::vector<double> parameters;
+
+   /**
+    * @brief setSegments Uses a list of non-contiguous segments as data instead of the data vector
+    * The memory of the segments must stay valid until the result is obtained or the computation aborted,
+    * either kept alive by the owner or by the client.
+    * @param dataSegments the segments in order
+    * @param owner the object owning the memory of the segments (can be null)
+    */
+   void setSegments(std::vector<DataSegment> dataSegments, std::shared_ptr<const void> owner = nullptr) {
+      segments = std::move(dataSegments);
+      segmentsOwner = std::move(owner);
+   }
+
+   /**
+    * @brief setGenerator Uses data generated on the fly by the compute engines instead of the data vector
+    * @param dataGenerator the description of the data (iota, constant, affine or strided view)
+    * @param owner the object owning the memory of a strided view (can be null)
+    */
+   void setGenerator(const Generator &dataGenerator, std::shared_ptr<const void> owner = nullptr) {
+      generator = dataGenerator;
+      segmentsOwner = std::move(owner);
+   }
+
+   /**
+    * @brief setPacked Uses compressed integers as data instead of the data vector, the compute engines decode them
+    * block by block
+    * @param packedIntegers the compressed integers (see PackedIntegers::encode)
+    */
+   void setPacked(std::shared_ptr<const PackedIntegers> packedIntegers) {
+      packed = std::move(packedIntegers);
+   }
+
+   /**
+    * @brief payload Returns the view on the data the compute engines will work on
+    */
+   [[nodiscard]] Payload payload() const {
+      if (packed) {
+         return Payload(packed);
+      }
+      if (generator) {
+         return Payload(*generator, segmentsOwner);
+      }
+      return segments.empty() ? Payload(data) : Payload(segments, segmentsOwner);
+   }
+
+private:
+   std::vector<DataSegment> segments;
+   std::optional<Generator> generator;
+   std::shared_ptr<const PackedIntegers> packed;
+   std::shared_ptr<const void> segmentsOwner;
 };
 
+class PartitionedJob;
+
 /**
  * @brief The Request class is a request for a computation with and id and data
  */
@@ -60,19 +140,79 @@ class Request {
 public:
    Request() : data(nullptr) {}
 
-   Request(std::shared_ptr<std::vector<double>> data, int id) : data(std::move(data)), id(id) {}
+   Request(std::shared_ptr<std::vector<double>> data, RequestId id) : data(data), payload(data), id(id) {}
 
-   Request(const Computation &c, int id) : data(c.data), id(id) {}
+   Request(const Computation &c, RequestId id) : data(c.data), payload(c.payload()), id(id), computationType(c.computationType) {
+      if (!c.parameters.empty()) {
+         parameters = std::make_shared<const std::vector<double>>(c.parameters);
+      }
+   }
 
-   [[nodiscard]] int getId() const { return id; }
+   /**
+    * @brief Request Constructs the request for a part of a partitioned request
+    * @param whole the partitioned request
+    * @param job the job coordinating the parts
+    * @param part the index of the part
+    */
+   Request(const Request &whole, std::shared_ptr<PartitionedJob> job, unsigned part) : Request(whole) {
+      this->job = std::move(job);
+      this->part = part;
+   }
+
+   [[nodiscard]] RequestId getId() const { return id; }
+
+   [[nodiscard]] ComputationType getComputationType() const { return computationType; }
+
+   /**
+    * @brief toComputation Returns a computation equivalent to the request (to submit it again)
+    */
+   [[nodiscard]] Computation toComputation() const {
+      Computation c(computationType);
+      if (data) {
+         c.data = std::const_pointer_cast<std::vector<double>>(data);
+      }
+      if (payload.getPacked()) {
+         c.setPacked(payload.getPacked());
+      } else if (auto generator = payload.getGenerator()) {
+         c.setGenerator(*generator, payload.getOwner());
+      } else if (!payload.sameBuffer(Payload(data))) {
+         auto segments = payload.getSegments();
+         c.setSegments(std::vector<DataSegment>(segments.begin(), segments.end()), payload.getOwner());
+      }
+      if (parameters) {
+         c.parameters = *parameters;
+      }
+      return c;
+   }
 
    /**
-    * @brief data The data for the computation
+    * @brief data The data vector of the computation (empty if the computation uses segments)
     */
    std::shared_ptr<const std::vector<double>> data;
 
+   /**
+    * @brief payload The data for the computation, as segments
+    */
+   Payload payload;
+
+   /**
+    * @brief parameters The parameters of the computation (null if there are none)
+    */
+   std::shared_ptr<const std::vector<double>> parameters;
+
+   /**
+    * @brief job The job this request is a part of (null if the request is not partitioned)
+    */
+   std::shared_ptr<PartitionedJob> job;
+
+   /**
+    * @brief part The index of the part of the job
+    */
+   unsigned part{0};
+
 private:
-   int id{0};
+   RequestId id{0};
+   ComputationType computationType{ComputationType::A};
 };
 
 /**
@@ -80,20 +220,104 @@ private:
  */
 class Result {
 public:
-   Result(int id, double result) : id(id), result(result) {}
+   Result(RequestId id, double result) : id(id), result(result) {}
+
+   Result(RequestId id, double result, std::shared_ptr<const std::vector<double>> values) : id(id), result(result),
+                                                                                           values(std::move(values)) {}
 
-   [[nodiscard]] int getId() const { return id; }
+   [[nodiscard]] RequestId getId() const { return id; }
 
    [[nodiscard]] double getResult() const { return result; }
 
+   /**
+    * @brief getValues Returns the array computed by the computations giving more than a scalar (can be null)
+    */
+   [[nodiscard]] const std::shared_ptr<const std::vector<double>> &getValues() const { return values; }
+
    bool operator<(const Result &other) const {
       // Tri en fonction de l'attribut
       return id < other.id;
    }
 
 private:
-   int id;
+   RequestId id;
    double result;
+   std::shared_ptr<const std::vector<double>> values;
+};
+
+/**
+ * @brief The PartitionedJob class coordinates a request split in parts that are computed by several compute engines.
+ * The job goes through phases, every part of a phase is queued as a request (with the same id) and the next phase
+ * starts when all of them are done. The parts write their results in the job, disjoint parts never conflict.
+ */
+class PartitionedJob {
+public:
+   virtual ~PartitionedJob() = default;
+
+   /**
+    * @brief getPhase Returns the current phase (starting at 0)
+    */
+   [[nodiscard]] unsigned getPhase() const { return phase; }
+
+   /**
+    * @brief phaseParts Returns the indices of the parts to compute in the current phase
+    */
+   [[nodiscard]] virtual std::vector<unsigned> phaseParts() const = 0;
+
+   /**
+    * @brief nextPhase Called (in the monitor) when every part of the phase is done, prepares the next phase
+    * @return true if there is a next phase, false if the job is complete
+    */
+   virtual bool nextPhase() = 0;
+
+   /**
+    * @brief result Returns the result of the complete job
+    * @param id the id of the request
+    */
+   [[nodiscard]] virtual Result result(RequestId id) const = 0;
+
+protected:
+   unsigned phase{0};
+};
+
+/**
+ * @brief The Aggregator class combines the results of a group of computations into a single result, in the order
+ * they complete : the combiner must be associative and commutative
+ */
+class Aggregator {
+public:
+   using Combiner = std::function<double(double, double)>;
+
+   /**
+    * @brief Aggregator Creates a custom aggregation
+    * @param initial the result of an empty group, the neutral element of the combiner
+    * @param combiner combines the result so far with the result of a computation
+    */
+   Aggregator(double initial, Combiner combiner) : initial(initial), combiner(std::move(combiner)) {}
+
+   static Aggregator sum() { return Aggregator(0.0, [](double a, double b) { return a + b; }); }
+
+   static Aggregator product() { return Aggregator(1.0, [](double a, double b) { return a * b; }); }
+
+   static Aggregator min() {
+      return Aggregator(std::numeric_limits<double>::infinity(), [](double a, double b) { return b < a ? b : a; });
+   }
+
+   static Aggregator max() {
+      return Aggregator(-std::numeric_limits<double>::infinity(), [](double a, double b) { return b > a ? b : a; });
+   }
+
+   double initial;
+   Combiner combiner;
+};
+
+/**
+ * @brief The HandedBackRequest struct is a request handed back by a drain, to be submitted elsewhere : a single
+ * computation (requestComputation) or the computations of a group with their aggregator (requestGroup)
+ */
+struct HandedBackRequest {
+   std::vector<Computation> computations;
+   std::optional<Aggregator> aggregator;
 };
 
 /**
@@ -106,7 +330,7 @@ public:
     * @param c The computation to be done
     * @return The assigned id (should follow the order of the requests)
     */
-   virtual int requestComputation(Computation c) = 0;
+   virtual RequestId requestComputation(Computation c) = 0;
 
    /**
     * @brief abortComputation Allows the client to abort a computation
@@ -115,7 +339,7 @@ public:
     * engine working on it if there was one.
     * @param id the id of the computation to be aborted
     */
-   virtual void abortComputation(int id) = 0;
+   virtual void abortComputation(RequestId id) = 0;
 
    /**
     * @brief getNextResult Method that provides the next result.
@@ -144,13 +368,31 @@ public:
     * @param id the id of the request the compute engine is currently working on
     * @return true if the worker should continue working on the request with id id
     */
-   virtual bool continueWork(int id) = 0;
+   virtual bool continueWork(RequestId id) = 0;
 
    /**
     * @brief provideResult Allows a compute engine to prove a result to the buffer
     * @param result the result that has been computed
     */
    virtual void provideResult(Result result) = 0;
+
+   /**
+    * @brief getWorkBatch is used to ask for several small requests of a given type at once.
+    * The first request is the one getWork would give, if it is small the other small requests of the queue are
+    * added to the batch (in order).
+    * @param computationType the type of work that is wanted
+    * @param batch filled with the requests to be fulfilled (at least one)
+    * @param maxRequests the maximum number of requests in the batch
+    * @param maxElements the maximum number of elements of a small request
+    */
+   virtual void getWorkBatch(ComputationType computationType, std::vector<Request> &batch, size_t maxRequests,
+                             size_t maxElements) = 0;
+
+   /**
+    * @brief provideResults Allows a compute engine to provide the results of a batch at once
+    * @param batch the results that have been computed
+    */
+   virtual void provideResults(const std::vector<Result> &batch) = 0;
 };
 
 /**
@@ -163,10 +405,14 @@ struct ResultWithId {
     * @param id the id of the result
     * @param result the optional result
     */
-   ResultWithId(int id, std::optional<Result> result) : id(id), result(result) {}
+   ResultWithId(RequestId id, std::optional<Result> result, ComputationType type = ComputationType::A, size_t size = 0) :
+      id(id), result(result), type(type), size(size) {}
 
-   int id;
+   RequestId id;
    std::optional<Result> result;
+   // The type and the number of elements of the request (to explain why it blocks the delivery)
+   ComputationType type;
+   size_t size;
 };
 
 
@@ -190,19 +436,63 @@ public:
    ComputationManager(int maxQueueSize = 10);
 
    // Client Interface
-   int requestComputation(Computation c) override;
+   RequestId requestComputation(Computation c) override;
+
+   /**
+    * @brief requestGroup Requests several computations whose results are combined in the buffer as they complete :
+    * the group has a single id and a single result, delivered in the order of the requests like any other. Only the
+    * scalar results are combined. The computations of a group are never coalesced nor split, aborting the group
+    * aborts all of them (even while the group waits for space in a queue : the rest of it is not queued) and a drain
+    * lets the group finish instead of handing it back.
+    * @param computations the computations of the group
+    * @param aggregator how their results are combined
+    * @return the id of the group
+    */
+   RequestId requestGroup(const std::vector<Computation> &computations, Aggregator aggregator);
 
-   void abortComputation(int resultWithId) override;
+   void abortComputation(RequestId id) override;
 
    Result getNextResult() override;
 
    // Compute Engine Interface
    Request getWork(ComputationType computationType) override;
 
-   bool continueWork(int id) override;
+   bool continueWork(RequestId id) override;
 
    void provideResult(Result resultChecked) override;
 
+   void getWorkBatch(ComputationType computationType, std::vector<Request> &batch, size_t maxRequests,
+                     size_t maxElements) override;
+
+   void provideResults(const std::vector<Result> &batch) override;
+
+   /**
+    * @brief tryGetWork Takes a request of a given type like getWork, without waiting
+    * @param computationType the type of work that is wanted
+    * @return the request, or nothing if there isn't any that can be dispatched now or if the buffer is stopped
+    */
+   std::optional<Request> tryGetWork(ComputationType computationType);
+
+   /**
+    * @brief tryGetWorkBatch Takes a batch of requests of a given type like getWorkBatch, without waiting
+    * @return false (and an empty batch) if there isn't any request that can be dispatched now or if the buffer is
+    * stopped
+    */
+   bool tryGetWorkBatch(ComputationType computationType, std::vector<Request> &batch, size_t maxRequests,
+                        size_t maxElements);
+
+   /**
+    * @brief WorkListener Is told that requests of a type may be dispatched. It is called in the monitor, so it must
+    * return quickly and must not call the buffer.
+    */
+   using WorkListener = std::function<void(ComputationType)>;
+
+   /**
+    * @brief setWorkListener Sets the function told when requests may be dispatched (used by an engine pool serving
+    * several buffers), null to remove it
+    */
+   void setWorkListener(WorkListener listener);
+
 
    // Control Interface
    /**
@@ -210,22 +500,269 @@ public:
     */
    void stop();
 
+   /**
+    * @brief drain Stops the buffer gracefully : new requests are refused (StopException), the requests that have not
+    * started are removed and handed back, the running ones are given until the deadline to finish and their results
+    * to be delivered (getNextResult throws once everything is delivered), then the buffer is stopped.
+    * @param deadline the time given to the running requests
+    * A group none of whose computations was dispatched has not started either.
+    * @return the requests that never started, indexed by their id, to be submitted elsewhere
+    */
+   std::map<RequestId, HandedBackRequest> drain(std::chrono::milliseconds deadline);
+
+   /**
+    * @brief Partitioner Returns the job splitting a request of a given payload and parameters, or null if it is
+    * not worth it
+    */
+   using Partitioner = std::function<std::shared_ptr<PartitionedJob>(const Payload &, const std::vector<double> &)>;
+
+   /**
+    * @brief setPartitioner Sets how the requests of a computation type are split between compute engines
+    * (it can be called while requests are submitted, the requests submitted after it use the new partitioner)
+    * @param computationType the computation type
+    * @param partitioner the partitioner, null to never split the requests
+    */
+   void setPartitioner(ComputationType computationType, Partitioner partitioner);
+
+   /**
+    * @brief setHeadOfLineWindow Sets how close to the delivery head (the id getNextResult waits for) a request
+    * must be to be dispatched before the other requests of its type (1 by default : only the head, 0 : disabled).
+    * The queues are in the order of the ids, this matters for the requests queued out of that order : the parts of
+    * the later phases of a partitioned request, and the requests passed by the cache affinity.
+    * @param window the distance in ids from the head
+    */
+   void setHeadOfLineWindow(size_t window);
+
+   /**
+    * @brief setReorderingTolerance Sets how far from the delivery head a result may be delivered before it (0 by
+    * default : strictly in order). With a tolerance k, getNextResult gives the oldest ready result among the k
+    * pending results right after the head, so a consumer never receives more than k results ahead of one still
+    * missing.
+    * @param tolerance the number of pending results after the head
+    */
+   void setReorderingTolerance(size_t tolerance);
+
+   /**
+    * @brief setRequestCoalescing Enables or disables the coalescing of identical requests (disabled by default).
+    * When enabled, a request with the same type and data as a request that is still queued or being computed
+    * does not take a queue slot, its id is attached to the existing execution and gets a copy of its result.
+    * @param enabled true to coalesce identical requests
+    */
+   void setRequestCoalescing(bool enabled);
+
+   /**
+    * @brief InlineExecutor Computes the scalar result of a request synchronously, in the calling thread
+    */
+   using InlineExecutor = std::function<double(const Payload &)>;
+
+   /**
+    * @brief setInlineExecutor Registers the way a computation type can be executed outside of a compute engine
+    * (used by the consumer assisted execution)
+    * @param computationType the computation type
+    * @param executor the executor
+    */
+   void setInlineExecutor(ComputationType computationType, InlineExecutor executor);
+
+   /**
+    * @brief setConsumerAssist Enables or disables the consumer assisted execution (disabled by default). When
+    * enabled, a client blocked in getNextResult executes queued requests that have an inline executor itself : the
+    * request at the delivery head first, else a small queued request.
+    * @param enabled true to let the consumer help
+    */
+   void setConsumerAssist(bool enabled);
+
+   // The maximum number of elements of a request that is not the head and that the consumer executes
+   static constexpr size_t ASSIST_MAX_ELEMENTS = 4096;
+
+   /**
+    * @brief setCacheAffinity Enables or disables the cache affinity routing (disabled by default). When enabled, an
+    * engine asking for work gets in priority a request whose data buffer was last dispatched on the CPU it runs on
+    * (by an engine of any type), among the AFFINITY_WINDOW oldest requests. The requests close to the delivery head
+    * still go first.
+    * @param enabled true to route by cache affinity
+    */
+   void setCacheAffinity(bool enabled);
+
+   // The number of oldest requests of a queue among which a request with cache affinity is looked for
+   static constexpr size_t AFFINITY_WINDOW = 8;
+
+   /**
+    * @brief setBandwidthGovernor Enables or disables the bandwidth governor (disabled by default). The bulk
+    * streaming requests (A and B requests of at least BULK_MIN_BYTES) are memory bandwidth bound : the governor
+    * measures the bandwidth each one gets and caps how many of them are computed at once to the number that gives
+    * the best aggregate bandwidth. The engines that cannot take a bulk request wait, leaving their core to the
+    * compute bound engines.
+    * @param enabled true to govern the bulk requests
+    */
+   void setBandwidthGovernor(bool enabled);
+
+   /**
+    * @brief getBulkLimit Returns the number of bulk requests the governor currently lets run at once
+    */
+   size_t getBulkLimit();
+
+   /**
+    * @brief The HeadOfLineStall struct describes a stretch where the delivery head was not ready while other results
+    * were ready behind it
+    */
+   struct HeadOfLineStall {
+      // The id blocking the delivery, its type and number of elements
+      RequestId id;
+      ComputationType type;
+      size_t payloadSize;
+      // How long it blocked the delivery
+      std::chrono::microseconds duration;
+      // The number of results ready behind it when the stretch ended
+      size_t piledUp;
+   };
+
+   /**
+    * @brief getWorstStalls Returns the longest head-of-line stretches seen so far, from the worst (the stretches are
+    * only tracked while a reporter is set, see setHeadOfLineReporter)
+    * @param count the maximum number of stretches (at most MAX_KEPT_STALLS are kept)
+    */
+   std::vector<HeadOfLineStall> getWorstStalls(size_t count = MAX_KEPT_STALLS);
+
+   /**
+    * @brief headOfLineReport Returns a text report of the head-of-line blocking with the worst stretches
+    * @param count the number of stretches detailed
+    */
+   std::string headOfLineReport(size_t count = REPORTED_STALLS);
+
+   /**
+    * @brief setHeadOfLineReporter Gives the head-of-line report to a function periodically (the consumer calls it
+    * from getNextResult, outside of the monitor, once the period is over). The head-of-line stretches are only
+    * tracked while a reporter is set.
+    * @param period the period of the report
+    * @param reporter the function receiving the report (null to stop reporting and tracking)
+    */
+   void setHeadOfLineReporter(std::chrono::milliseconds period, std::function<void(const std::string &)> reporter);
+
+   // The number of worst head-of-line stretches kept
+   static constexpr size_t MAX_KEPT_STALLS = 32;
+   // The number of stretches detailed in a report by default
+   static constexpr size_t REPORTED_STALLS = 5;
+
+   // The size from which an A or B request is a bulk streaming request
+   static constexpr size_t BULK_MIN_BYTES = 1 << 20;
+   // The maximum number of bulk requests computed at once
+   static constexpr size_t MAX_BULK_LIMIT = 16;
+   // The number of low bits of an id holding its slot index, hence the maximum number of ids not delivered yet
+   static constexpr unsigned SLOT_BITS = 20;
+   static constexpr size_t MAX_PENDING_IDS = size_t(1) << SLOT_BITS;
+   // The last sequence number of an id, the high bits of the ids
+   static constexpr uint64_t MAX_SEQUENCE = (uint64_t(1) << (64 - SLOT_BITS)) - 1;
+
 protected:
 
+   // The queues and the results are stored in pooled (resident) nodes, they do not allocate in steady state
+   using RequestQueue = std::list<Request, PoolAllocator<Request>>;
+
    // The maximum size of the buffer for each computation type
    const size_t MAX_TOLERATED_QUEUE_SIZE;
    // A map that maps a computation type to the list of requests for this type of computation
-   std::map<ComputationType, std::list<Request>> buffer;
+   std::map<ComputationType, RequestQueue> buffer;
    // The list of results (or currently being computed results) with their id
-   std::list<ResultWithId> results;
-   // An array that stores the condition on which we should wait if the request queue is empty for each computation type
-   std::array<Condition, 3> emptyQueuePerType;
-   // An array that stores the condition on which we should wait if the request queue is full for each computation type
-   std::array<Condition, 3> fullQueuePerType;
+   using ResultList = std::list<ResultWithId, PoolAllocator<ResultWithId>>;
+   ResultList results;
+   // The slot of an id not delivered yet gives its entry in the results, a slot whose id does not match is free or
+   // reused by another id
+   struct Slot {
+      RequestId id{NO_REQUEST};
+      ResultList::iterator result;
+   };
+   std::vector<Slot> slots;
+   std::vector<uint32_t> freeSlots;
+   // The sequence number of the next id of this buffer (0 is never used, it would give NO_REQUEST)
+   uint64_t nextSequence{1};
+   // The groups whose result is not delivered yet, indexed by the id of the group. The slots of the ids of their
+   // computations point to the result entry of the group.
+   struct Group {
+      Aggregator aggregator;
+      double value;
+      size_t remaining;
+      std::vector<RequestId> members;
+   };
+   std::map<RequestId, Group> groups;
+   // A map that stores the condition on which we should wait if the request queue is empty for each computation type
+   std::map<ComputationType, Condition> emptyQueuePerType;
+   // A map that stores the condition on which we should wait if the request queue is full for each computation type
+   std::map<ComputationType, Condition> fullQueuePerType;
    // Condition on which we should wait if the result we are waiting for is not yet computed
    Condition notExpectedResult;
    // A boolean that is true if the app is terminated
    bool stopped;
+   // A boolean that is true if the buffer is draining (or drained)
+   bool draining{false};
+   // Tells a drain waiting for the running requests that every result was delivered or that the buffer stopped
+   // (set in the monitor, the drain waits outside of it until its deadline)
+   std::mutex drainMutex;
+   std::condition_variable drainDone;
+   bool drainOver{false};
+   // A boolean that is true if identical requests are coalesced
+   bool coalescing{false};
+   // The partitioners of the computation types whose requests can be split
+   std::map<ComputationType, Partitioner> partitioners;
+   // The partitioned requests that are being computed, indexed by their id
+   struct PartitionedExecution {
+      Request request;
+      std::shared_ptr<PartitionedJob> job;
+      size_t remainingParts;
+   };
+   std::map<RequestId, PartitionedExecution> partitionedExecutions;
+   // The distance to the delivery head under which a request is dispatched in priority
+   size_t headOfLineWindow{1};
+   // The distance to the delivery head under which a ready result is delivered before the head
+   size_t reorderingTolerance{0};
+   // The executions (queued or being computed) that can be shared, indexed by the fingerprint of their request
+   std::multimap<size_t, Request> sharedExecutions;
+   // A map that maps the id of a shared execution to the ids that will receive its result
+   std::map<RequestId, std::vector<RequestId>> attachedIds;
+   // The executors of the computation types the consumer can execute itself
+   std::map<ComputationType, InlineExecutor> inlineExecutors;
+   // A boolean that is true if the consumer executes requests while it waits for the head
+   bool consumerAssist{false};
+   // A boolean that is true if the requests are routed by cache affinity
+   bool cacheAffinity{false};
+   // The CPU on which the data buffers were dispatched last (fixed size, the oldest entries are replaced)
+   struct BufferTouch {
+      const void *buffer;
+      int cpu;
+   };
+   std::array<BufferTouch, 64> recentTouches{};
+   size_t nextTouch{0};
+   // A boolean that is true if the bulk requests are governed
+   bool bandwidthGovernor{false};
+   // The bulk requests being computed, with their size, their dispatch time, how many ran with them and whether they
+   // were aborted (their engine may still be streaming)
+   struct BulkExecution {
+      size_t bytes;
+      std::chrono::steady_clock::time_point start;
+      size_t concurrency;
+      bool aborted;
+   };
+   std::map<RequestId, BulkExecution> bulkExecutions;
+   // The number of bulk requests that can be computed at once
+   size_t bulkLimit{1};
+   // The aggregate bandwidth (bytes per second, moving average) measured for each number of concurrent bulk requests
+   std::array<double, MAX_BULK_LIMIT + 1> bandwidthAt{};
+   // The head blocking the delivery in the current stretch (NO_REQUEST if there isn't any), its type, size and since when
+   RequestId stallHead{NO_REQUEST};
+   ComputationType stallType{ComputationType::A};
+   size_t stallSize{0};
+   std::chrono::steady_clock::time_point stallStart;
+   // The stretches seen so far : their number, their total duration and the worst ones
+   size_t stallCount{0};
+   std::chrono::microseconds totalStallTime{0};
+   std::vector<HeadOfLineStall> worstStalls;
+   // The number of results ready and not delivered yet
+   size_t readyResults{0};
+   // The periodic report of the head-of-line blocking
+   std::function<void(const std::string &)> headOfLineReporter;
+   std::chrono::milliseconds headOfLineReportPeriod{0};
+   std::chrono::steady_clock::time_point lastHeadOfLineReport;
+   // Told when requests may be dispatched
+   WorkListener workListener;
 
 private:
    /**
@@ -233,7 +770,205 @@ private:
     */
    inline void throwStopException() { throw StopException(); }
 
-   static int nextId;
+   /**
+    * @brief waitForWork Waits (in the monitor) until there is a request of a given type
+    * @param type the computation type
+    * @throw StopException (after leaving the monitor) if the buffer is stopped
+    */
+   void waitForWork(ComputationType type);
+
+   /**
+    * @brief takeWork Removes the request to dispatch from the non empty queue of a type (in the monitor)
+    */
+   Request takeWork(ComputationType type);
+
+   /**
+    * @brief takeWorkBatch Removes a batch of requests to dispatch from the non empty queue of a type (in the monitor)
+    */
+   void takeWorkBatch(ComputationType type, std::vector<Request> &batch, size_t maxRequests, size_t maxElements);
+
+   /**
+    * @brief announceWork Wakes up an engine waiting for a type and tells the work listener (in the monitor)
+    */
+   void announceWork(ComputationType type);
+
+   /**
+    * @brief storeResult Stores the result provided by a compute engine (in the monitor)
+    * @param result the result
+    * @return true if a result is now available to the client
+    */
+   bool storeResult(Result result);
+
+   /**
+    * @brief queueParts Queues the parts of the current phase of a partitioned request
+    * @param execution the execution of the request
+    */
+   void queueParts(PartitionedExecution &execution);
+
+   /**
+    * @brief selectWork Chooses the request of a non empty queue to dispatch to a compute engine.
+    * The requests in the head of line window go first (before the newer requests queued ahead of the parts of a
+    * partitioned head, and before the requests favoured by the cache affinity), then the oldest one.
+    * @param queue the queue of a computation type
+    * @return the chosen request
+    */
+   RequestQueue::iterator selectWork(RequestQueue &queue);
+
+   /**
+    * @brief trackHeadOfLine Starts or ends a head-of-line stretch after a change of the results
+    */
+   void trackHeadOfLine();
+
+   /**
+    * @brief notifyDrain Wakes a drain up once there is nothing left to wait for (in the monitor)
+    */
+   void notifyDrain();
+
+   /**
+    * @brief setResult Gives its result to a result entry
+    */
+   void setResult(ResultList::iterator it, Result result);
+
+   /**
+    * @brief headOfLineReportLocked Returns the head-of-line report (to be called in the monitor)
+    */
+   [[nodiscard]] std::string headOfLineReportLocked(size_t count) const;
+
+   /**
+    * @brief isBulk Returns true if a request is a bulk streaming request governed by the bandwidth governor
+    */
+   [[nodiscard]] bool isBulk(const Request &request) const;
+
+   /**
+    * @brief dispatchable Returns true if a request can be dispatched now (a bulk request needs a free slot)
+    */
+   [[nodiscard]] bool dispatchable(const Request &request) const;
+
+   /**
+    * @brief hasDispatchable Returns true if a queue has a request that can be dispatched now
+    */
+   [[nodiscard]] bool hasDispatchable(const RequestQueue &queue) const;
+
+   /**
+    * @brief oldestDispatchable Returns the oldest request of a queue that can be dispatched now
+    * @param queue the queue (having such a request)
+    */
+   RequestQueue::iterator oldestDispatchable(RequestQueue &queue);
+
+   /**
+    * @brief startBulk Records that a bulk request is dispatched
+    */
+   void startBulk(const Request &request);
+
+   /**
+    * @brief abortBulk Records that a bulk request being computed was aborted, it keeps its place among the bulk
+    * requests until its engine returns (continueWork or provideResult)
+    * @param id the id of the request (nothing is done if it is not a bulk request being computed)
+    */
+   void abortBulk(RequestId id);
+
+   /**
+    * @brief finishBulk Records that the engine of a bulk request returned and, if the request completed without
+    * being aborted, adjusts the number of bulk requests computed at once from the bandwidth it got
+    * @param id the id of the request (nothing is done if it is not a bulk request being computed)
+    * @param completed true if the request completed, false if its engine stopped
+    */
+   void finishBulk(RequestId id, bool completed);
+
+   /**
+    * @brief selectAffineWork Chooses the request whose data is still in the caches of the calling CPU, else the
+    * oldest one
+    * @param queue the queue (not empty)
+    * @return the chosen request
+    */
+   RequestQueue::iterator selectAffineWork(RequestQueue &queue);
+
+   /**
+    * @brief recordTouch Records that the data of a request is dispatched on the calling CPU
+    */
+   void recordTouch(const Payload &payload);
+
+   /**
+    * @brief bufferKey Returns the address identifying the data buffer of a payload (null for generated data)
+    */
+   static const void *bufferKey(const Payload &payload);
+
+   /**
+    * @brief takeAssistWork Removes from the buffer a request the consumer can execute : the head request if it is
+    * queued, else a small request (the oldest of its queue)
+    * @return the request or nothing if there isn't any
+    */
+   std::optional<Request> takeAssistWork();
+
+   /**
+    * @brief fingerprint Computes the hash used to find the identical requests
+    * @param payload the data of the computation
+    * @param type the type of the computation
+    * @return the hash of the type and the data of the computation
+    */
+   static size_t fingerprint(const Payload &payload, ComputationType type);
+
+   /**
+    * @brief attachToSharedExecution Attaches a new id to an execution identical to the computation if there is one.
+    * Called in the monitor, it leaves the monitor meanwhile to hash and compare the data.
+    * @param payload the data of the computation
+    * @param type the type of the computation
+    * @param hash set to the fingerprint of the computation
+    * @return the new id or nullopt if there is no identical execution
+    */
+   std::optional<RequestId> attachToSharedExecution(const Payload &payload, ComputationType type, size_t &hash);
+
+   /**
+    * @brief releaseSharedExecution Forgets a shared execution (its result is provided or nobody wants it anymore)
+    * @param executionId the id of the execution
+    */
+   void releaseSharedExecution(RequestId executionId);
+
+   /**
+    * @brief newId Gives a new id and its slot
+    * @return the new id or NO_REQUEST if there are already MAX_PENDING_IDS ids not delivered or if the sequence
+    * numbers are exhausted
+    */
+   RequestId newId();
+
+   /**
+    * @brief addResult Places the result entry of a new id at the back of the delivery order
+    */
+   void addResult(RequestId id, ComputationType type, size_t size);
+
+   /**
+    * @brief nextDeliverable Returns the oldest ready result within the reordering tolerance of the head, or the end of
+    * the results if there isn't any
+    */
+   ResultList::iterator nextDeliverable();
+
+   /**
+    * @brief combineGroupResult Combines the result of a computation of a group into the result of the group
+    * @param group the result entry of the group
+    * @return true if it was the last result the group waited for
+    */
+   bool combineGroupResult(ResultList::iterator group, const Result &result);
+
+   /**
+    * @brief abortLocked Aborts a request or a group, in the monitor
+    */
+   void abortLocked(RequestId id);
+
+   /**
+    * @brief findResult Returns the result entry of an id in O(1), or the end of the results if the id was delivered,
+    * aborted or never given by this buffer
+    */
+   ResultList::iterator findResult(RequestId id);
+
+   /**
+    * @brief eraseResult Removes a result entry and frees its slot, the id becomes stale
+    */
+   void eraseResult(ResultList::iterator it);
+
+   /**
+    * @brief sequence Returns the sequence number of an id, the ids of a buffer are ordered by it
+    */
+   static uint64_t sequence(RequestId id) { return id >> SLOT_BITS; }
 };
 
 #endif // COMPUTATIONMANAGER_H
@@ -3,3 +3,7 @@
 int ComputeEngineA::nextId = 0;
 int ComputeEngineB::nextId = 0;
 int ComputeEngineC::nextId = 0;
+int ComputeEngineD::nextId = 0;
+int ComputeEngineE::nextId = 0;
+int ComputeEngineBatch::nextId = 0;
+int ComputeEnginePlugin::nextId = 0;
@@ -11,7 +11,17 @@
 
 #include <memory>
 #include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
 #include "computationmanager.h"
+#include "engineprofiler.h"
+#include "kernelcalibration.h"
+#include "kernelplugin.h"
 #include "launchable.h"
 
 /**
@@ -54,11 +64,17 @@ protected:
      */
     [[nodiscard]] virtual double getResult() const = 0;
 
+    /**
+     * @brief getValues returns the array computed by the computation, if it gives more than a scalar
+     * @return the array or null
+     */
+    [[nodiscard]] virtual std::shared_ptr<const std::vector<double>> getValues() const {return nullptr;}
+
     /**
      * @brief getCurrentRequestId Returns the id of the current request
      * @return the id of the current request
      */
-    [[nodiscard]] virtual int getCurrentRequestId() const = 0;
+    [[nodiscard]] virtual RequestId getCurrentRequestId() const = 0;
 
     /**
      * @brief stopComputation Stops the current omputation
@@ -89,10 +105,14 @@ protected:
      * @brief run The behavior of a compute engine
      */
     void run() override {
+        // Only the stack actually used by the engine is kept resident
+        MemoryResidency::lockStack();
+        EngineProfiler::instance().registerCurrentThread(myType());
         try {
             for(;;) {
                 // Get a request from my type
                 startComputation(computationManager->getWork(myType()));
+                EngineProfiler::setCurrentRequest(getCurrentRequestId());
 
                 for(;;) {
                     // Continue with computation (do partial computation)
@@ -101,7 +121,7 @@ protected:
                     // If done provide the result to the manager
                     if (isComputationDone()) {
                         stopComputation();
-                        computationManager->provideResult(Result(getCurrentRequestId(), getResult()));
+                        computationManager->provideResult(Result(getCurrentRequestId(), getResult(), getValues()));
                         break;
                     }
                     // else if I should not continue, stop
@@ -115,6 +135,7 @@ protected:
         } catch (ComputationManager::StopException& e) {
             // Stop my computation
             stopComputation();
+            EngineProfiler::instance().unregisterCurrentThread();
             return;
         }
     }
@@ -128,17 +149,34 @@ class ComputeEngineCommon : public virtual AbstractComputeEngine, public Compute
 protected:
     Request currentRequest;
     std::shared_ptr<const std::vector<double>> data;
+    Payload payload;
     bool computationDone = false;
     double result = 0.0;
+    std::shared_ptr<const std::vector<double>> values;
     bool started = false;
+    // The accumulators and the blocks between two abort checks calibrated for the host, read for every request
+    KernelConfiguration configuration;
 
     // Overriden functions, documentation is given in the AbstractComputeEngine class
-    void startComputation(const Request& r) override {currentRequest = r; data = r.data; computationDone = false;}
+    void startComputation(const Request& r) override {currentRequest = r; data = r.data; payload = r.payload; values = nullptr; computationDone = false; configuration = KernelCalibration::current();}
     [[nodiscard]] bool isComputationDone() const override {return computationDone;}
     [[nodiscard]] double getResult() const override {return result;}
-    [[nodiscard]] int getCurrentRequestId() const override {return currentRequest.getId();}
+    [[nodiscard]] std::shared_ptr<const std::vector<double>> getValues() const override {return values;}
+    [[nodiscard]] RequestId getCurrentRequestId() const override {return currentRequest.getId();}
     void stopComputation() override {started = false;}
 
+    /**
+     * @brief reduceRange Adds or multiplies the elements [from, to) of the payload with the calibrated kernel
+     */
+    [[nodiscard]] double reduceRange(size_t from, size_t to, bool product) const {
+        double acc[KernelCalibration::MAX_ACCUMULATORS];
+        std::fill(std::begin(acc), std::end(acc), product ? 1.0 : 0.0);
+        payload.forEachChunk(from, to, [&](const double* chunk, size_t n) {
+            KernelCalibration::reduce(configuration.accumulators, acc, chunk, n, product);
+        });
+        return KernelCalibration::combine(configuration.accumulators, acc, product);
+    }
+
     // Allows the ComputeEngineGUI class to have access (to display events)
     friend class ComputeEngineGUI;
 };
@@ -149,7 +187,23 @@ protected:
 class ComputeEngineA : public ComputeEngineCommon
 {
 public:
-    ComputeEngineA(std::shared_ptr<ComputationManager> computationManager): AbstractComputeEngine(std::move(computationManager), nextId++) {}
+    ComputeEngineA(std::shared_ptr<ComputeEngineInterface> computationManager): AbstractComputeEngine(std::move(computationManager), nextId++) {}
+
+    /**
+     * @brief compute Computes the result of a request at once (inline executor)
+     */
+    static double compute(const Payload& payload) {
+        if (const Generator* generator = payload.getGenerator()) {
+            if (auto closedForm = generator->closedFormSum()) {
+                return *closedForm;
+            }
+        }
+        double sum = 0.0;
+        payload.forEachChunk(0, payload.size(), [&sum](const double* chunk, size_t n) {
+            sum = std::accumulate(chunk, chunk + n, sum);
+        });
+        return sum;
+    }
 
 protected:
     [[nodiscard]] ComputationType myType() const override {return ComputationType::A;}
@@ -159,12 +213,23 @@ protected:
         computationDone = false;
         started = true;
         result = 0.0;
-        position = 0;
+        offset = 0;
     }
 
     void advanceComputation() override {
-        if (position < data->size()) {
-            result += data->at(position++);
+        // A generated range with a closed form is computed at once
+        if (const Generator* generator = payload.getGenerator()) {
+            if (auto closedForm = generator->closedFormSum()) {
+                result = *closedForm;
+                computationDone = true;
+                return;
+            }
+        }
+        // A block of the calibrated size at a time (segments walked in place, generated or decoded on the fly)
+        if (offset < payload.size()) {
+            size_t to = std::min(payload.size(), offset + configuration.blockSize);
+            result += reduceRange(offset, to, false);
+            offset = to;
         } else {
             computationDone = true;
         }
@@ -173,7 +238,7 @@ protected:
     void printStartMessage() const override {qDebug() << "[START] Compute Engine A -" << id << "launched";}
     void printCompletionMessage() const override {qDebug() << "[STOP] Compute Engine A -" << id;}
 private:
-    size_t position = 0;
+    size_t offset = 0;
 
     static int nextId;
 };
@@ -182,7 +247,23 @@ private:
 class ComputeEngineB : public ComputeEngineCommon
 {
 public:
-    ComputeEngineB(std::shared_ptr<ComputationManager> computationManager): AbstractComputeEngine(std::move(computationManager), nextId++) {}
+    ComputeEngineB(std::shared_ptr<ComputeEngineInterface> computationManager): AbstractComputeEngine(std::move(computationManager), nextId++) {}
+
+    /**
+     * @brief compute Computes the result of a request at once (inline executor)
+     */
+    static double compute(const Payload& payload) {
+        if (const Generator* generator = payload.getGenerator()) {
+            if (auto closedForm = generator->closedFormProduct()) {
+                return *closedForm;
+            }
+        }
+        double product = 1.0;
+        payload.forEachChunk(0, payload.size(), [&product](const double* chunk, size_t n) {
+            product = std::accumulate(chunk, chunk + n, product, std::multiplies<>());
+        });
+        return product;
+    }
 
 protected:
     [[nodiscard]] ComputationType myType() const override {return ComputationType::B;}
@@ -192,12 +273,23 @@ protected:
         computationDone = false;
         started = true;
         result = 1.0;
-        position = 0;
+        offset = 0;
     }
 
     void advanceComputation() override {
-        if (position < data->size()) {
-            result *= data->at(position++);
+        // A generated range with a closed form is computed at once
+        if (const Generator* generator = payload.getGenerator()) {
+            if (auto closedForm = generator->closedFormProduct()) {
+                result = *closedForm;
+                computationDone = true;
+                return;
+            }
+        }
+        // A block of the calibrated size at a time (segments walked in place, generated or decoded on the fly)
+        if (offset < payload.size()) {
+            size_t to = std::min(payload.size(), offset + configuration.blockSize);
+            result *= reduceRange(offset, to, true);
+            offset = to;
         } else {
             computationDone = true;
         }
@@ -206,7 +298,7 @@ protected:
     void printStartMessage() const override {qDebug() << "[START] Compute Engine B -" << id << "launched";}
     void printCompletionMessage() const override {qDebug() << "[STOP] Compute Engine B -" << id;}
 private:
-    size_t position = 0;
+    size_t offset = 0;
 
     static int nextId;
 };
@@ -215,7 +307,14 @@ private:
 class ComputeEngineC : public ComputeEngineCommon
 {
 public:
-    ComputeEngineC(std::shared_ptr<ComputationManager> computationManager): AbstractComputeEngine(std::move(computationManager), nextId++) {}
+    ComputeEngineC(std::shared_ptr<ComputeEngineInterface> computationManager): AbstractComputeEngine(std::move(computationManager), nextId++) {}
+
+    /**
+     * @brief compute Computes the result of a request at once (inline executor)
+     */
+    static double compute(const Payload& payload) {
+        return payload.size() == 2 ? payload.at(0) / payload.at(1) : NAN;
+    }
 protected:
     [[nodiscard]] ComputationType myType() const override {return ComputationType::C;}
 
@@ -226,11 +325,11 @@ protected:
     }
 
     void advanceComputation() override {
-        if (data->size() != 2) {
+        if (payload.size() != 2) {
             result = NAN;
             qDebug() << "Division requires exactly two operands";
         } else {
-            result = data->at(0) / data->at(1);
+            result = payload.at(0) / payload.at(1);
         }
         computationDone = true;
     }
@@ -241,4 +340,714 @@ private:
     static int nextId;
 };
 
+/**
+ * @brief The ScanJob class splits a prefix scan between the D compute engines (reduce then scan).
+ * Phase 0 : every part computes the sum of its range.
+ * Phase 1 : every part scans its range starting from the sum of the parts before it.
+ */
+class ScanJob : public PartitionedJob
+{
+public:
+    ScanJob(const Payload& payload, unsigned parts, size_t blockSize):
+        output(std::make_shared<std::vector<double>>(payload.size())), sums(parts, 0.0), offsets(parts, 0.0) {
+        // The ranges are aligned on blocks
+        size_t blocks = (payload.size() + blockSize - 1) / blockSize;
+        for (unsigned i = 0; i <= parts; ++i) {
+            bounds.push_back(std::min(payload.size(), blocks * i / parts * blockSize));
+        }
+    }
+
+    [[nodiscard]] std::vector<unsigned> phaseParts() const override {
+        std::vector<unsigned> parts(sums.size());
+        std::iota(parts.begin(), parts.end(), 0);
+        return parts;
+    }
+
+    bool nextPhase() override {
+        if (phase == 0) {
+            // Exclusive scan of the sums of the parts
+            double offset = 0.0;
+            for (size_t i = 0; i < sums.size(); ++i) {
+                offsets[i] = offset;
+                offset += sums[i];
+            }
+            phase = 1;
+            return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] Result result(RequestId id) const override {
+        return Result(id, output->empty() ? 0.0 : output->back(), output);
+    }
+
+    [[nodiscard]] size_t begin(unsigned part) const {return bounds[part];}
+    [[nodiscard]] size_t end(unsigned part) const {return bounds[part + 1];}
+    [[nodiscard]] double offset(unsigned part) const {return offsets[part];}
+    void setSum(unsigned part, double sum) {sums[part] = sum;}
+
+    const std::shared_ptr<std::vector<double>> output;
+
+private:
+    std::vector<size_t> bounds;
+    std::vector<double> sums;
+    std::vector<double> offsets;
+};
+
+// Computation engine D will compute the prefix sums (inclusive scan), alone or with other D engines for large data
+class ComputeEngineD : public ComputeEngineCommon
+{
+public:
+    ComputeEngineD(std::shared_ptr<ComputeEngineInterface> computationManager): AbstractComputeEngine(std::move(computationManager), nextId++) {}
+
+    /**
+     * @brief BLOCK_SIZE The alignment of the parts of a split scan (the engines process blocks of the calibrated size
+     * between two abort checks)
+     */
+    static constexpr size_t BLOCK_SIZE = 4096;
+
+    /**
+     * @brief PARALLEL_THRESHOLD The number of elements from which a scan is split between the D engines
+     */
+    static constexpr size_t PARALLEL_THRESHOLD = 64 * BLOCK_SIZE;
+
+    /**
+     * @brief partitioner Returns the partitioner splitting the large scans in one part per engine
+     * @param engines the number of D engines
+     */
+    static ComputationManager::Partitioner partitioner(unsigned engines) {
+        return [engines](const Payload& payload, const std::vector<double>& /*parameters*/) -> std::shared_ptr<PartitionedJob> {
+            if (engines < 2 || payload.size() < PARALLEL_THRESHOLD) {
+                return nullptr;
+            }
+            return std::make_shared<ScanJob>(payload, engines, BLOCK_SIZE);
+        };
+    }
+
+protected:
+    [[nodiscard]] ComputationType myType() const override {return ComputationType::D;}
+
+    void startComputation(const Request& r) override {
+        ComputeEngineCommon::startComputation(r);
+        computationDone = false;
+        started = true;
+        job = std::dynamic_pointer_cast<ScanJob>(r.job);
+        if (job) {
+            part = r.part;
+            position = job->begin(part);
+            end = job->end(part);
+            scanning = job->getPhase() == 1;
+            carry = scanning ? job->offset(part) : 0.0;
+            output = job->output;
+        } else {
+            // Small scan, done alone in a single pass
+            position = 0;
+            end = payload.size();
+            scanning = true;
+            carry = 0.0;
+            output = std::make_shared<std::vector<double>>(payload.size());
+        }
+    }
+
+    void advanceComputation() override {
+        if (position < end) {
+            size_t count = std::min(configuration.blockSize, end - position);
+            if (scanning) {
+                scanBlock(position, count);
+            } else {
+                carry += reduceRange(position, position + count, false);
+            }
+            position += count;
+        } else {
+            result = carry;
+            if (job) {
+                if (!scanning) {
+                    job->setSum(part, carry);
+                }
+            } else {
+                values = output;
+            }
+            computationDone = true;
+        }
+    }
+
+    void printStartMessage() const override {qDebug() << "[START] Compute Engine D -" << id << "launched";}
+    void printCompletionMessage() const override {qDebug() << "[STOP] Compute Engine D -" << id;}
+private:
+    // Number of lanes of a chunk scanned together (independent dependency chains)
+    static constexpr size_t SCAN_LANES = 8;
+
+    // Inclusive scan of a block, continuing from carry. Every chunk is cut in SCAN_LANES contiguous lanes whose partial
+    // scans advance together, then each lane is shifted by the carry plus the sums of the lanes before it (a loop
+    // without dependency, vectorized). The rounding may differ in the last bits from a serial scan.
+    void scanBlock(size_t from, size_t count) {
+        double* out = output->data() + from;
+        payload.forEachChunk(from, from + count, [&](const double* chunk, size_t n) {
+            size_t laneSize = n / SCAN_LANES;
+            double sums[SCAN_LANES] = {};
+            for (size_t i = 0; i < laneSize; ++i) {
+                for (size_t l = 0; l < SCAN_LANES; ++l) {
+                    sums[l] += chunk[l * laneSize + i];
+                    out[l * laneSize + i] = sums[l];
+                }
+            }
+            double offset = carry;
+            for (size_t l = 0; l < SCAN_LANES; ++l) {
+                double* lane = out + l * laneSize;
+                for (size_t i = 0; i < laneSize; ++i) {
+                    lane[i] += offset;
+                }
+                offset += sums[l];
+            }
+            // The elements left after the lanes
+            for (size_t i = SCAN_LANES * laneSize; i < n; ++i) {
+                offset += chunk[i];
+                out[i] = offset;
+            }
+            carry = offset;
+            out += n;
+        });
+    }
+
+    std::shared_ptr<ScanJob> job;
+    std::shared_ptr<std::vector<double>> output;
+    unsigned part = 0;
+    size_t position = 0;
+    size_t end = 0;
+    bool scanning = true;
+    double carry = 0.0;
+
+    static int nextId;
+};
+
+/**
+ * @brief The SelectionQuery struct is the query of a selection (type E), decoded from the parameters of the request.
+ * Parameters : {0, k} for the k largest values, {1, q...} for the quantiles q (in [0, 1]) and {2, q...} for
+ * approximate quantiles (relative error below 2^-10).
+ */
+struct SelectionQuery
+{
+    enum class Mode {TopK = 0, Quantiles = 1, ApproximateQuantiles = 2};
+
+    Mode mode = Mode::TopK;
+    size_t k = 0;
+    std::vector<double> quantiles;
+    bool valid = false;
+
+    static SelectionQuery decode(const std::vector<double>& parameters) {
+        SelectionQuery query;
+        if (parameters.size() < 2) {
+            return query;
+        }
+        switch (static_cast<int>(parameters[0])) {
+        case 0:
+            query.mode = Mode::TopK;
+            query.k = parameters[1] >= 1.0 ? static_cast<size_t>(parameters[1]) : 0;
+            query.valid = query.k > 0;
+            break;
+        case 1:
+        case 2:
+            query.mode = parameters[0] == 1.0 ? Mode::Quantiles : Mode::ApproximateQuantiles;
+            query.quantiles.assign(parameters.begin() + 1, parameters.end());
+            query.valid = std::all_of(query.quantiles.begin(), query.quantiles.end(), [](double q) {return q >= 0.0 && q <= 1.0;});
+            break;
+        default:
+            break;
+        }
+        return query;
+    }
+
+    /**
+     * @brief rank Returns the (0 based) rank of the quantile q among n sorted values (nearest rank)
+     */
+    static size_t rank(double q, size_t n) {
+        auto r = static_cast<size_t>(std::ceil(q * static_cast<double>(n)));
+        return r == 0 ? 0 : std::min(r, n) - 1;
+    }
+
+    /**
+     * @brief pushTopK Adds a value to the min-heap of the k largest values
+     */
+    void pushTopK(std::vector<double>& heap, double value) const {
+        if (heap.size() < k) {
+            heap.push_back(value);
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        } else if (value > heap.front()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            heap.back() = value;
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        }
+    }
+};
+
+/**
+ * @brief The SelectionJob class splits a selection between the E compute engines.
+ * Top-k : every part keeps its k largest values in a heap, the heaps are merged at the end.
+ * Quantiles : radix selection on the bits of the values (in an order preserving encoding), every phase the parts
+ * count the next DIGIT_BITS bits of the values still candidates for each quantile, the merged counts give the digit
+ * of each quantile. The memory used is bounded by the counts, not by the data.
+ */
+class SelectionJob : public PartitionedJob
+{
+public:
+    /**
+     * @brief DIGIT_BITS The number of bits of the values resolved by each phase
+     */
+    static constexpr unsigned DIGIT_BITS = 11;
+    static constexpr size_t BUCKETS = size_t(1) << DIGIT_BITS;
+
+    SelectionJob(SelectionQuery query, size_t size, unsigned parts, size_t blockSize):
+        query(std::move(query)), candidates(parts), histograms(parts), prefixes(this->query.quantiles.size(), 0),
+        ranks(this->query.quantiles.size(), 0) {
+        size_t blocks = (size + blockSize - 1) / blockSize;
+        for (unsigned i = 0; i <= parts; ++i) {
+            bounds.push_back(std::min(size, blocks * i / parts * blockSize));
+        }
+        // The exact quantiles need every bit, the approximate ones stop after the exponent and 10 bits of mantissa
+        lastPhase = this->query.mode == SelectionQuery::Mode::ApproximateQuantiles ? 2 : (64 + DIGIT_BITS - 1) / DIGIT_BITS;
+        for (auto& histogram : histograms) {
+            histogram.assign(this->query.mode == SelectionQuery::Mode::TopK ? 0 : this->query.quantiles.size() * BUCKETS, 0);
+        }
+    }
+
+    [[nodiscard]] std::vector<unsigned> phaseParts() const override {
+        std::vector<unsigned> parts(candidates.size());
+        std::iota(parts.begin(), parts.end(), 0);
+        return parts;
+    }
+
+    bool nextPhase() override {
+        if (query.mode == SelectionQuery::Mode::TopK) {
+            std::vector<double> merged;
+            for (const auto& heap : candidates) {
+                merged.insert(merged.end(), heap.begin(), heap.end());
+            }
+            size_t k = std::min(query.k, merged.size());
+            std::partial_sort(merged.begin(), merged.begin() + k, merged.end(), std::greater<>());
+            merged.resize(k);
+            values = std::make_shared<std::vector<double>>(std::move(merged));
+            return false;
+        }
+
+        // The counts of the parts are merged, then each quantile follows the bucket holding its rank
+        std::vector<uint64_t> total(BUCKETS);
+        for (size_t q = 0; q < query.quantiles.size(); ++q) {
+            std::fill(total.begin(), total.end(), 0);
+            for (const auto& histogram : histograms) {
+                for (size_t b = 0; b < BUCKETS; ++b) {
+                    total[b] += histogram[q * BUCKETS + b];
+                }
+            }
+            if (phase == 0) {
+                count = std::accumulate(total.begin(), total.end(), uint64_t(0));
+                if (count == 0) {
+                    values = std::make_shared<std::vector<double>>(query.quantiles.size(), NAN);
+                    return false;
+                }
+                ranks[q] = SelectionQuery::rank(query.quantiles[q], count);
+            }
+            uint64_t before = 0;
+            size_t b = 0;
+            while (before + total[b] <= ranks[q]) {
+                before += total[b++];
+            }
+            prefixes[q] |= static_cast<uint64_t>(b) << shift(phase);
+            ranks[q] -= before;
+        }
+
+        ++phase;
+        if (phase < lastPhase) {
+            for (auto& histogram : histograms) {
+                std::fill(histogram.begin(), histogram.end(), 0);
+            }
+            return true;
+        }
+        // The bits that are not resolved are set to the middle of the remaining range
+        auto result = std::make_shared<std::vector<double>>();
+        for (auto prefix : prefixes) {
+            if (shift(phase - 1) > 0) {
+                prefix |= uint64_t(1) << (shift(phase - 1) - 1);
+            }
+            result->push_back(fromOrderedKey(prefix));
+        }
+        values = result;
+        return false;
+    }
+
+    [[nodiscard]] Result result(RequestId id) const override {
+        return Result(id, values->empty() ? NAN : values->front(), values);
+    }
+
+    /**
+     * @brief countBlock Counts the digits of the current phase of the values that are still candidates
+     * @param histogram the counts of the part
+     * @param chunk the values
+     * @param n the number of values
+     */
+    void countBlock(std::vector<uint64_t>& histogram, const double* chunk, size_t n) const {
+        uint64_t mask = phase == 0 ? 0 : ~uint64_t(0) << (shift(phase - 1));
+        uint64_t digitMask = (uint64_t(1) << (64 - shift(phase) - DIGIT_BITS * phase)) - 1;
+        for (size_t i = 0; i < n; ++i) {
+            if (std::isnan(chunk[i])) {
+                continue;
+            }
+            uint64_t key = orderedKey(chunk[i]);
+            auto digit = static_cast<size_t>((key >> shift(phase)) & digitMask);
+            for (size_t q = 0; q < prefixes.size(); ++q) {
+                if ((key & mask) == prefixes[q]) {
+                    ++histogram[q * BUCKETS + digit];
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] size_t begin(unsigned part) const {return bounds[part];}
+    [[nodiscard]] size_t end(unsigned part) const {return bounds[part + 1];}
+    [[nodiscard]] const SelectionQuery& getQuery() const {return query;}
+    std::vector<double>& candidatesOf(unsigned part) {return candidates[part];}
+    std::vector<uint64_t>& histogramOf(unsigned part) {return histograms[part];}
+
+    /**
+     * @brief orderedKey Encodes a double in an integer that has the same order
+     */
+    static uint64_t orderedKey(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+    }
+
+    /**
+     * @brief fromOrderedKey Decodes a double encoded by orderedKey
+     */
+    static double fromOrderedKey(uint64_t key) {
+        uint64_t bits = (key >> 63) ? key & ~(uint64_t(1) << 63) : ~key;
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+private:
+    // The position of the lowest bit of the digit resolved by a phase
+    static unsigned shift(unsigned phase) {
+        return DIGIT_BITS * (phase + 1) >= 64 ? 0 : 64 - DIGIT_BITS * (phase + 1);
+    }
+
+    const SelectionQuery query;
+    std::vector<size_t> bounds;
+    unsigned lastPhase;
+    std::vector<std::vector<double>> candidates;
+    std::vector<std::vector<uint64_t>> histograms;
+    std::vector<uint64_t> prefixes;
+    std::vector<uint64_t> ranks;
+    uint64_t count = 0;
+    std::shared_ptr<const std::vector<double>> values;
+};
+
+// Computation engine E will select the k largest values or quantiles, alone or with other E engines for large data
+class ComputeEngineE : public ComputeEngineCommon
+{
+public:
+    ComputeEngineE(std::shared_ptr<ComputeEngineInterface> computationManager): AbstractComputeEngine(std::move(computationManager), nextId++) {}
+
+    /**
+     * @brief BLOCK_SIZE The alignment of the parts of a split selection (the engines process blocks of the calibrated
+     * size between two abort checks)
+     */
+    static constexpr size_t BLOCK_SIZE = 4096;
+
+    /**
+     * @brief PARALLEL_THRESHOLD The number of elements from which a selection is split between the E engines
+     */
+    static constexpr size_t PARALLEL_THRESHOLD = 64 * BLOCK_SIZE;
+
+    /**
+     * @brief topK Returns a computation of the k largest values (sorted from the largest), the data is to be filled
+     */
+    static Computation topK(size_t k) {
+        Computation c(ComputationType::E);
+        c.parameters = {static_cast<double>(SelectionQuery::Mode::TopK), static_cast<double>(k)};
+        return c;
+    }
+
+    /**
+     * @brief quantiles Returns a computation of quantiles (in the order given), the data is to be filled
+     */
+    static Computation quantiles(const std::vector<double>& q, bool approximate = false) {
+        Computation c(ComputationType::E);
+        c.parameters.push_back(static_cast<double>(approximate ? SelectionQuery::Mode::ApproximateQuantiles : SelectionQuery::Mode::Quantiles));
+        c.parameters.insert(c.parameters.end(), q.begin(), q.end());
+        return c;
+    }
+
+    /**
+     * @brief partitioner Returns the partitioner splitting the large selections in one part per engine
+     * @param engines the number of E engines
+     */
+    static ComputationManager::Partitioner partitioner(unsigned engines) {
+        return [engines](const Payload& payload, const std::vector<double>& parameters) -> std::shared_ptr<PartitionedJob> {
+            auto query = SelectionQuery::decode(parameters);
+            if (engines < 2 || payload.size() < PARALLEL_THRESHOLD || !query.valid) {
+                return nullptr;
+            }
+            return std::make_shared<SelectionJob>(std::move(query), payload.size(), engines, BLOCK_SIZE);
+        };
+    }
+
+protected:
+    [[nodiscard]] ComputationType myType() const override {return ComputationType::E;}
+
+    void startComputation(const Request& r) override {
+        ComputeEngineCommon::startComputation(r);
+        computationDone = false;
+        started = true;
+        job = std::dynamic_pointer_cast<SelectionJob>(r.job);
+        alone = false;
+        if (job) {
+            part = r.part;
+            query = job->getQuery();
+            position = job->begin(part);
+            end = job->end(part);
+        } else {
+            query = SelectionQuery::decode(r.parameters ? *r.parameters : std::vector<double>());
+            part = 0;
+            position = 0;
+            end = query.valid ? payload.size() : 0;
+            // Large quantiles that were not split (in a group, without partitioner) are selected alone by radix,
+            // in a single part : the counts bound the memory, not the data
+            if (query.valid && query.mode != SelectionQuery::Mode::TopK && payload.size() >= PARALLEL_THRESHOLD) {
+                job = std::make_shared<SelectionJob>(query, payload.size(), 1, BLOCK_SIZE);
+                alone = true;
+            }
+        }
+        kept.clear();
+    }
+
+    void advanceComputation() override {
+        if (position < end) {
+            size_t count = std::min(configuration.blockSize, end - position);
+            payload.forEachChunk(position, position + count, [this](const double* chunk, size_t n) {
+                if (job && query.mode != SelectionQuery::Mode::TopK) {
+                    job->countBlock(job->histogramOf(part), chunk, n);
+                } else {
+                    for (size_t i = 0; i < n; ++i) {
+                        if (std::isnan(chunk[i])) {
+                            continue;
+                        }
+                        if (query.mode == SelectionQuery::Mode::TopK) {
+                            query.pushTopK(kept, chunk[i]);
+                        } else {
+                            // Small selection, there are less values than PARALLEL_THRESHOLD
+                            kept.push_back(chunk[i]);
+                        }
+                    }
+                }
+            });
+            position += count;
+        } else {
+            if (alone) {
+                // Every phase of the radix selection reads the data again
+                if (job->nextPhase()) {
+                    position = job->begin(part);
+                    return;
+                }
+                auto selected = job->result(currentRequest.getId());
+                result = selected.getResult();
+                values = selected.getValues();
+            } else if (job) {
+                if (query.mode == SelectionQuery::Mode::TopK) {
+                    job->candidatesOf(part) = std::move(kept);
+                }
+                result = 0.0;
+            } else {
+                auto selected = std::make_shared<std::vector<double>>(select());
+                result = selected->empty() ? NAN : selected->front();
+                values = selected;
+            }
+            computationDone = true;
+        }
+    }
+
+    void printStartMessage() const override {qDebug() << "[START] Compute Engine E -" << id << "launched";}
+    void printCompletionMessage() const override {qDebug() << "[STOP] Compute Engine E -" << id;}
+private:
+    // Selection done by a single engine on the values kept
+    std::vector<double> select() {
+        std::vector<double> selected;
+        if (!query.valid) {
+            return selected;
+        }
+        if (query.mode == SelectionQuery::Mode::TopK) {
+            std::sort_heap(kept.begin(), kept.end(), std::greater<>());
+            return kept;
+        }
+        for (double q : query.quantiles) {
+            if (kept.empty()) {
+                selected.push_back(NAN);
+                continue;
+            }
+            auto nth = kept.begin() + static_cast<std::ptrdiff_t>(SelectionQuery::rank(q, kept.size()));
+            std::nth_element(kept.begin(), nth, kept.end());
+            selected.push_back(*nth);
+        }
+        return selected;
+    }
+
+    std::shared_ptr<SelectionJob> job;
+    SelectionQuery query;
+    std::vector<double> kept;
+    // The job is the engine's own, not split between engines
+    bool alone = false;
+    unsigned part = 0;
+    size_t position = 0;
+    size_t end = 0;
+
+    static int nextId;
+};
+
+// Computation engine reducing batches of small requests of type A (sum) or B (product) with a single handoff
+class ComputeEngineBatch : public Launchable
+{
+public:
+    ComputeEngineBatch(std::shared_ptr<ComputeEngineInterface> computationManager, ComputationType type):
+        computationManager(std::move(computationManager)), type(type), id(nextId++) {
+        if (type != ComputationType::A && type != ComputationType::B) {
+            throw std::invalid_argument("Only the A and B computations can be batched");
+        }
+    }
+
+    /**
+     * @brief MAX_BATCH_REQUESTS The maximum number of requests reduced together
+     */
+    static constexpr size_t MAX_BATCH_REQUESTS = 64;
+
+    /**
+     * @brief SMALL_REQUEST_SIZE The maximum number of elements of a request that can be batched
+     */
+    static constexpr size_t SMALL_REQUEST_SIZE = 256;
+
+protected:
+    void run() override {
+        MemoryResidency::lockStack();
+        // The accumulators and the blocks between two abort checks are the ones calibrated for the host
+        configuration = KernelCalibration::current();
+        EngineProfiler::instance().registerCurrentThread(type);
+        try {
+            for (;;) {
+                computationManager->getWorkBatch(type, batch, MAX_BATCH_REQUESTS, SMALL_REQUEST_SIZE);
+                results.clear();
+                for (const auto& request : batch) {
+                    EngineProfiler::setCurrentRequest(request.getId());
+                    double value;
+                    if (reduce(request, value)) {
+                        results.emplace_back(request.getId(), value);
+                    }
+                }
+                computationManager->provideResults(results);
+            }
+        // I got interrupted
+        } catch (ComputationManager::StopException& e) {
+            EngineProfiler::instance().unregisterCurrentThread();
+            return;
+        }
+    }
+
+    void printStartMessage() const override {qDebug() << "[START] Compute Engine Batch" << (type == ComputationType::A ? "A" : "B") << "-" << id << "launched";}
+    void printCompletionMessage() const override {qDebug() << "[STOP] Compute Engine Batch" << (type == ComputationType::A ? "A" : "B") << "-" << id;}
+
+private:
+    // Reduces the segments of a request, a large request (alone in its batch) is checked for abort between blocks
+    bool reduce(const Request& request, double& value) const {
+        bool product = type == ComputationType::B;
+        if (const Generator* generator = request.payload.getGenerator()) {
+            if (auto closedForm = product ? generator->closedFormProduct() : generator->closedFormSum()) {
+                value = *closedForm;
+                return true;
+            }
+        }
+        double acc[KernelCalibration::MAX_ACCUMULATORS];
+        std::fill(std::begin(acc), std::end(acc), product ? 1.0 : 0.0);
+        size_t size = request.payload.size();
+        for (size_t position = 0; position < size; position += configuration.blockSize) {
+            if (position > 0 && !computationManager->continueWork(request.getId())) {
+                return false;
+            }
+            request.payload.forEachChunk(position, std::min(size, position + configuration.blockSize), [&](const double* chunk, size_t n) {
+                KernelCalibration::reduce(configuration.accumulators, acc, chunk, n, product);
+            });
+        }
+        value = KernelCalibration::combine(configuration.accumulators, acc, product);
+        return true;
+    }
+
+    const std::shared_ptr<ComputeEngineInterface> computationManager;
+    const ComputationType type;
+    const int id;
+    // Reused from one batch to the next
+    std::vector<Request> batch;
+    std::vector<Result> results;
+    // The kernel configuration of the host
+    KernelConfiguration configuration;
+
+    static int nextId;
+};
+
+// Computation engine running a kernel loaded from a plugin (see KernelRegistry)
+class ComputeEnginePlugin : public ComputeEngineCommon
+{
+public:
+    ComputeEnginePlugin(std::shared_ptr<ComputeEngineInterface> computationManager, ComputationType type, const Labo6KernelDescriptor* kernel):
+        AbstractComputeEngine(std::move(computationManager), nextId++), type(type), kernel(kernel),
+        // The state is stored in max aligned blocks so that the kernel can put any type in it
+        state(new std::max_align_t[(kernel->stateSize + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t) + 1]) {}
+
+    /**
+     * @brief inlineExecutor Returns the inline executor of a kernel, which computes a request at once
+     */
+    static ComputationManager::InlineExecutor inlineExecutor(const Labo6KernelDescriptor* kernel) {
+        return [kernel](const Payload& payload) {
+            std::unique_ptr<std::max_align_t[]> state(new std::max_align_t[(kernel->stateSize + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t) + 1]);
+            kernel->init(state.get(), payload.size());
+            payload.forEachChunk(0, payload.size(), [&](const double* chunk, size_t n) {
+                kernel->step(state.get(), chunk, n);
+            });
+            return kernel->finish(state.get());
+        };
+    }
+
+protected:
+    [[nodiscard]] ComputationType myType() const override {return type;}
+
+    void startComputation(const Request& r) override {
+        ComputeEngineCommon::startComputation(r);
+        computationDone = false;
+        started = true;
+        position = 0;
+        kernel->init(state.get(), payload.size());
+    }
+
+    void advanceComputation() override {
+        if (position < payload.size()) {
+            size_t count = kernel->chunkSize == 0 ? payload.size() - position : std::min(kernel->chunkSize, payload.size() - position);
+            // A chunk spanning several segments is given to the kernel piece by piece
+            payload.forEachChunk(position, position + count, [this](const double* chunk, size_t n) {
+                kernel->step(state.get(), chunk, n);
+            });
+            position += count;
+        } else {
+            result = kernel->finish(state.get());
+            computationDone = true;
+        }
+    }
+
+    void printStartMessage() const override {qDebug() << "[START] Compute Engine" << kernel->typeName << "-" << id << "launched";}
+    void printCompletionMessage() const override {qDebug() << "[STOP] Compute Engine" << kernel->typeName << "-" << id;}
+private:
+    const ComputationType type;
+    const Labo6KernelDescriptor* kernel;
+    std::unique_ptr<std::max_align_t[]> state;
+    size_t position = 0;
+
+    static int nextId;
+};
+
 #endif // COMPUTEENGINE_H
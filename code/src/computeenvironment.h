@@ -13,6 +13,8 @@
 
 #include "computationmanager.h"
 #include "computeengine.h"
+#include "enginepool.h"
+#include "kernelregistry.h"
 
 /**
  * @brief The ComputeEnvironment class represents a compute environment with compute engines and allows to launch them
@@ -24,21 +26,74 @@ public:
      * @brief ComputeEnvironment Constructs the compute environment that is attached to a given buffer
      * @param computationManager
      */
-    ComputeEnvironment(std::shared_ptr<ComputationManager> computationManager): computationManager(std::move(computationManager)) {}
+    ComputeEnvironment(std::shared_ptr<ComputationManager> computationManager): engineSource(computationManager), computationManager(std::move(computationManager)) {}
+
+    /**
+     * @brief ComputeEnvironment Constructs the compute environment whose engines serve the buffers of a pool
+     * (one environment for all of them, so the number of engines does not depend on the number of buffers)
+     * @param pool
+     */
+    ComputeEnvironment(std::shared_ptr<EnginePool> pool): engineSource(pool), pool(std::move(pool)) {}
 
     /**
      * @brief populateComputeEnvironment adds compute engines to the environment
      */
     void populateComputeEnvironment() {
-        addComputeEngine(ComputationType::A, 2);
-        addComputeEngine(ComputationType::B);
+        if (batchSmallRequests) {
+            addBatchComputeEngine(ComputationType::A, 2);
+            addBatchComputeEngine(ComputationType::B);
+        } else {
+            addComputeEngine(ComputationType::A, 2);
+            addComputeEngine(ComputationType::B);
+        }
         addComputeEngine(ComputationType::C);
+        addComputeEngine(ComputationType::D, 2);
+        addComputeEngine(ComputationType::E, 2);
+        // The kernels loaded from plugins get the number of engines they asked for
+        for (auto type : KernelRegistry::instance().types()) {
+            addComputeEngine(type, std::max(1u, KernelRegistry::instance().find(type)->suggestedEngines));
+        }
+        if (pool) {
+            pool->setTenantSetup(&ComputeEnvironment::setupManager);
+        } else {
+            setupManager(*computationManager);
+        }
+    }
+
+    /**
+     * @brief setupManager Prepares a buffer for the engines added by populateComputeEnvironment
+     * @param manager
+     */
+    static void setupManager(ComputationManager& manager) {
+        // The large scans are split between the D engines
+        manager.setPartitioner(ComputationType::D, ComputeEngineD::partitioner(2));
+        // And so are the large selections between the E engines
+        manager.setPartitioner(ComputationType::E, ComputeEngineE::partitioner(2));
+        for (auto type : KernelRegistry::instance().types()) {
+            manager.setInlineExecutor(type, ComputeEnginePlugin::inlineExecutor(KernelRegistry::instance().find(type)));
+        }
+        // The scalar computations can be executed by a consumer waiting for its result
+        manager.setInlineExecutor(ComputationType::A, ComputeEngineA::compute);
+        manager.setInlineExecutor(ComputationType::B, ComputeEngineB::compute);
+        manager.setInlineExecutor(ComputationType::C, ComputeEngineC::compute);
+    }
+
+    /**
+     * @brief setBatchSmallRequests Makes the A and B engines reduce the small requests by batches
+     * (to be called before populateComputeEnvironment)
+     * @param enabled true to use batch engines
+     */
+    void setBatchSmallRequests(bool enabled) {
+        batchSmallRequests = enabled;
     }
 
     /**
      * @brief startComputeEnvironment starts the compute engines in the environment
      */
     void startComputeEnvironment() {
+        if (!profilePath.empty()) {
+            EngineProfiler::instance().start(profileFrequency);
+        }
         for (auto& t : threads) {
             t->startThread();
         }
@@ -48,9 +103,31 @@ public:
      * @brief joinComputeEnvironment joins the compute engines in the environment
      */
     void joinComputeEnvironment() {
+        // The engines of a pool are stopped by the pool, not by the buffers
+        if (pool) {
+            pool->stop();
+        }
         for (auto& t : threads) {
             t->join();
         }
+        // The profile of the engines is written once they are stopped
+        if (!profilePath.empty()) {
+            EngineProfiler::instance().stop();
+            if (!EngineProfiler::instance().writeProfile(profilePath)) {
+                qWarning() << "Cannot write the profile" << profilePath.c_str();
+            }
+        }
+    }
+
+    /**
+     * @brief setProfiling Samples the compute engines while they run and writes a pprof profile when they are joined
+     * (to be called before startComputeEnvironment)
+     * @param path the profile file (empty to disable the profiling)
+     * @param frequency the number of samples per second of CPU time of an engine
+     */
+    void setProfiling(const std::string& path, unsigned frequency = EngineProfiler::DEFAULT_FREQUENCY) {
+        profilePath = path;
+        profileFrequency = frequency;
     }
 
 protected:
@@ -63,22 +140,49 @@ protected:
         for (unsigned i = 0; i < quantity; ++i) {
             switch(type) {
             case ComputationType::A :
-                threads.push_back(std::make_shared<ComputeEngineA>(computationManager));
+                threads.push_back(std::make_shared<ComputeEngineA>(engineSource));
                 break;
             case ComputationType::B :
-                threads.push_back(std::make_shared<ComputeEngineB>(computationManager));
+                threads.push_back(std::make_shared<ComputeEngineB>(engineSource));
                 break;
             case ComputationType::C :
-                threads.push_back(std::make_shared<ComputeEngineC>(computationManager));
+                threads.push_back(std::make_shared<ComputeEngineC>(engineSource));
+                break;
+            case ComputationType::D :
+                threads.push_back(std::make_shared<ComputeEngineD>(engineSource));
+                break;
+            case ComputationType::E :
+                threads.push_back(std::make_shared<ComputeEngineE>(engineSource));
                 break;
             default:
+                if (auto kernel = KernelRegistry::instance().find(type)) {
+                    threads.push_back(std::make_shared<ComputeEnginePlugin>(engineSource, type, kernel));
+                }
                 break;
             }
         }
     }
 
+    /**
+     * @brief addBatchComputeEngine Helper function to add compute engines reducing batches of small requests
+     * @param type A or B
+     * @param quantity
+     */
+    virtual void addBatchComputeEngine(ComputationType type, unsigned quantity = 1) {
+        for (unsigned i = 0; i < quantity; ++i) {
+            threads.push_back(std::make_shared<ComputeEngineBatch>(engineSource, type));
+        }
+    }
+
     std::vector<std::shared_ptr<Launchable>> threads;
+    // Where the engines get their work : the buffer, or the pool serving several buffers
+    std::shared_ptr<ComputeEngineInterface> engineSource;
     std::shared_ptr<ComputationManager> computationManager;
+    std::shared_ptr<EnginePool> pool;
+    bool batchSmallRequests = false;
+    // The file the profile of the engines is written to (empty if they are not profiled)
+    std::string profilePath;
+    unsigned profileFrequency = EngineProfiler::DEFAULT_FREQUENCY;
 };
 
 #endif // COMPUTEENVIRONMENT_H
@@ -0,0 +1,180 @@
+/**
+\file enginepool.cpp
+\author agent
+\date 19.10.2026
+
+Ce fichier contient l'implémentation du pool de moteurs de calcul partagé par plusieurs tampons. Le mutex du pool
+n'est jamais tenu pendant un appel à un tampon, qui appelle lui-même le pool depuis son moniteur.
+*/
+
+#include "enginepool.h"
+
+#include <algorithm>
+
+namespace {
+// The pool and the buffer the calling engine thread took its last work from
+thread_local const EnginePool *assignedPool = nullptr;
+thread_local std::shared_ptr<ComputationManager> assignedManager;
+}
+
+EnginePool::~EnginePool() {
+   for (auto &tenant: tenants) {
+      tenant->manager->setWorkListener(nullptr);
+   }
+}
+
+void EnginePool::attach(const std::shared_ptr<ComputationManager> &manager, double weight) {
+   std::function<void(ComputationManager &)> setup;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      // A new buffer starts at the current virtual time, it does not get the work it did not ask for before
+      tenants.push_back(std::make_shared<Tenant>(Tenant{manager, weight > 0.0 ? weight : 1.0, virtualTime, 0.0, {}, {}}));
+      setup = tenantSetup;
+   }
+   if (setup) {
+      setup(*manager);
+   }
+   const ComputationManager *key = manager.get();
+   manager->setWorkListener([this, key](ComputationType type) { announce(key, type); });
+   workAnnounced.notify_all();
+}
+
+void EnginePool::detach(const std::shared_ptr<ComputationManager> &manager) {
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      tenants.erase(std::remove_if(tenants.begin(), tenants.end(),
+                                   [&](const auto &tenant) { return tenant->manager == manager; }),
+                    tenants.end());
+   }
+   // A late announcement does not find the buffer anymore
+   manager->setWorkListener(nullptr);
+}
+
+void EnginePool::setTenantSetup(std::function<void(ComputationManager &)> setup) {
+   std::vector<std::shared_ptr<Tenant>> attached;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      tenantSetup = setup;
+      attached = tenants;
+   }
+   for (auto &tenant: attached) {
+      setup(*tenant->manager);
+   }
+}
+
+double EnginePool::served(const std::shared_ptr<ComputationManager> &manager) {
+   std::lock_guard<std::mutex> lock(mutex);
+   for (auto &tenant: tenants) {
+      if (tenant->manager == manager) {
+         return tenant->served;
+      }
+   }
+   return 0.0;
+}
+
+void EnginePool::stop() {
+   std::lock_guard<std::mutex> lock(mutex);
+   stopped = true;
+   workAnnounced.notify_all();
+}
+
+void EnginePool::announce(const ComputationManager *manager, ComputationType type) {
+   std::lock_guard<std::mutex> lock(mutex);
+   for (auto &tenant: tenants) {
+      if (tenant->manager.get() == manager) {
+         ++tenant->announced[type];
+         workAnnounced.notify_all();
+         return;
+      }
+   }
+}
+
+void EnginePool::take(ComputationType type, const std::function<size_t(ComputationManager &)> &tryTake) {
+   std::unique_lock<std::mutex> lock(mutex);
+   for (;;) {
+      if (stopped) {
+         throw ComputationManager::StopException();
+      }
+      // The buffers that may have work, the most behind first
+      std::vector<std::shared_ptr<Tenant>> candidates;
+      for (auto &tenant: tenants) {
+         auto exhausted = tenant->exhausted.find(type);
+         if (exhausted == tenant->exhausted.end() || exhausted->second != tenant->announced[type]) {
+            candidates.push_back(tenant);
+         }
+      }
+      if (candidates.empty()) {
+         workAnnounced.wait(lock);
+         continue;
+      }
+      std::stable_sort(candidates.begin(), candidates.end(),
+                       [](const auto &a, const auto &b) { return a->pass < b->pass; });
+      for (auto &tenant: candidates) {
+         unsigned long announced = tenant->announced[type];
+         lock.unlock();
+         size_t taken = tryTake(*tenant->manager);
+         lock.lock();
+         if (taken == 0) {
+            // An announcement made meanwhile keeps the buffer a candidate
+            tenant->exhausted[type] = announced;
+            continue;
+         }
+         // A buffer that was idle starts again from the virtual time, it does not catch up
+         double start = std::max(tenant->pass, virtualTime);
+         tenant->pass = start + static_cast<double>(taken) / tenant->weight;
+         tenant->served += static_cast<double>(taken);
+         virtualTime = start;
+         assignedPool = this;
+         assignedManager = tenant->manager;
+         return;
+      }
+   }
+}
+
+std::shared_ptr<ComputationManager> EnginePool::current() const {
+   return assignedPool == this ? assignedManager : nullptr;
+}
+
+Request EnginePool::getWork(ComputationType computationType) {
+   Request request;
+   take(computationType, [&](ComputationManager &manager) -> size_t {
+      auto taken = manager.tryGetWork(computationType);
+      if (!taken) {
+         return 0;
+      }
+      request = *taken;
+      return request.payload.size() + 1;
+   });
+   return request;
+}
+
+void EnginePool::getWorkBatch(ComputationType computationType, std::vector<Request> &batch, size_t maxRequests,
+                              size_t maxElements) {
+   take(computationType, [&](ComputationManager &manager) -> size_t {
+      if (!manager.tryGetWorkBatch(computationType, batch, maxRequests, maxElements)) {
+         return 0;
+      }
+      size_t elements = 0;
+      for (const auto &request: batch) {
+         elements += request.payload.size() + 1;
+      }
+      return elements;
+   });
+}
+
+bool EnginePool::continueWork(RequestId id) {
+   auto manager = current();
+   return manager && manager->continueWork(id);
+}
+
+void EnginePool::provideResult(Result result) {
+   if (auto manager = current()) {
+      manager->provideResult(std::move(result));
+   }
+}
+
+void EnginePool::provideResults(const std::vector<Result> &batch) {
+   if (auto manager = current()) {
+      manager->provideResults(batch);
+   }
+}
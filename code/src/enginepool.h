@@ -0,0 +1,114 @@
+/**
+\file enginepool.h
+\author agent
+\date 19.10.2026
+
+Ce fichier contient la classe EnginePool, un ensemble de moteurs de calcul partagé par plusieurs tampons
+(ComputationManager, un par client par exemple). Les moteurs demandent leur travail au pool, qui le prend dans le
+tampon choisi par une sélection équitable pondérée : chaque tampon avance d'un temps virtuel proportionnel au travail
+qu'il a reçu divisé par son poids, celui qui est le plus en retard est servi en premier. Le nombre de threads ne
+dépend donc plus du nombre de tampons.
+*/
+
+#ifndef ENGINEPOOL_H
+#define ENGINEPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "computationmanager.h"
+
+/**
+ * @brief The EnginePool class lets compute engines serve several buffers, chosen by weighted fair selection
+ */
+class EnginePool : public ComputeEngineInterface {
+public:
+   EnginePool() = default;
+
+   ~EnginePool();
+
+   /**
+    * @brief attach Serves a buffer (its work listener is replaced by the pool's one)
+    * @param manager the buffer
+    * @param weight the share of the engines given to the buffer when several ones have work, relative to the others
+    */
+   void attach(const std::shared_ptr<ComputationManager> &manager, double weight = 1.0);
+
+   /**
+    * @brief detach Stops serving a buffer (the requests the engines are working on are completed)
+    */
+   void detach(const std::shared_ptr<ComputationManager> &manager);
+
+   /**
+    * @brief setTenantSetup Sets the function preparing every attached buffer (partitioners, inline executors) for
+    * the engines of the pool, it is called on the buffers already attached too
+    */
+   void setTenantSetup(std::function<void(ComputationManager &)> setup);
+
+   /**
+    * @brief served Returns the work given to the engines for a buffer so far, in elements (requests count for one
+    * more element)
+    */
+   double served(const std::shared_ptr<ComputationManager> &manager);
+
+   /**
+    * @brief stop Stops the engines of the pool (they throw StopException), the buffers are not stopped
+    */
+   void stop();
+
+   // Compute Engine Interface, the results and the abort checks go to the buffer the request was taken from
+   Request getWork(ComputationType computationType) override;
+
+   bool continueWork(RequestId id) override;
+
+   void provideResult(Result result) override;
+
+   void getWorkBatch(ComputationType computationType, std::vector<Request> &batch, size_t maxRequests,
+                     size_t maxElements) override;
+
+   void provideResults(const std::vector<Result> &batch) override;
+
+private:
+   struct Tenant {
+      std::shared_ptr<ComputationManager> manager;
+      double weight;
+      // The virtual time of the buffer : the work it received divided by its weight
+      double pass;
+      double served{0.0};
+      // The number of times work of a type was announced, and its value when the buffer was last found without
+      // any (no entry : unknown, the buffer may have some)
+      std::map<ComputationType, unsigned long> announced;
+      std::map<ComputationType, unsigned long> exhausted;
+   };
+
+   /**
+    * @brief take Gives work of a type from the buffer the most behind that has some, waits if none has
+    * @param type the computation type
+    * @param tryTake takes the work from a buffer without waiting, returns the number of elements taken (0 if none)
+    */
+   void take(ComputationType type, const std::function<size_t(ComputationManager &)> &tryTake);
+
+   /**
+    * @brief announce Is told by a buffer that it may have work of a type
+    */
+   void announce(const ComputationManager *manager, ComputationType type);
+
+   /**
+    * @brief current Returns the buffer the calling engine took its last work from
+    */
+   [[nodiscard]] std::shared_ptr<ComputationManager> current() const;
+
+   std::mutex mutex;
+   std::condition_variable workAnnounced;
+   std::vector<std::shared_ptr<Tenant>> tenants;
+   std::function<void(ComputationManager &)> tenantSetup;
+   // The virtual time of the last buffer served, from which a buffer that was idle starts again
+   double virtualTime{0.0};
+   bool stopped{false};
+};
+
+#endif // ENGINEPOOL_H
@@ -0,0 +1,360 @@
+/**
+\file engineprofiler.cpp
+\author agent
+\date 19.10.2026
+
+Ce fichier contient l'implémentation du profileur par échantillonnage et l'encodage des profils au format pprof.
+*/
+
+#include "engineprofiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "kernelregistry.h"
+
+// Some C libraries only name the thread notified by a timer in the kernel headers
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+thread_local EngineProfiler::SampleBuffer *EngineProfiler::currentBuffer = nullptr;
+thread_local RequestId EngineProfiler::currentRequest = NO_REQUEST;
+
+namespace {
+/**
+ * @brief The ProtoWriter class encodes the protobuf messages of a pprof profile
+ */
+class ProtoWriter {
+public:
+   void varint(uint64_t value) {
+      while (value >= 0x80) {
+         bytes.push_back(static_cast<char>(value | 0x80));
+         value >>= 7;
+      }
+      bytes.push_back(static_cast<char>(value));
+   }
+
+   void field(int number, uint64_t value) {
+      varint(static_cast<uint64_t>(number) << 3);
+      varint(value);
+   }
+
+   void field(int number, const std::string &value) {
+      varint((static_cast<uint64_t>(number) << 3) | 2);
+      varint(value.size());
+      bytes += value;
+   }
+
+   void message(int number, const ProtoWriter &message) {
+      field(number, message.bytes);
+   }
+
+   void packed(int number, const std::vector<uint64_t> &values) {
+      ProtoWriter content;
+      for (auto value: values) {
+         content.varint(value);
+      }
+      message(number, content);
+   }
+
+   std::string bytes;
+};
+
+/**
+ * @brief The StringTable class gives the index of the strings of a profile (the first one is empty)
+ */
+class StringTable {
+public:
+   StringTable() { index(""); }
+
+   uint64_t index(const std::string &value) {
+      auto it = indices.find(value);
+      if (it != indices.end()) {
+         return it->second;
+      }
+      strings.push_back(value);
+      return indices[value] = strings.size() - 1;
+   }
+
+   std::vector<std::string> strings;
+
+private:
+   std::map<std::string, uint64_t> indices;
+};
+
+std::string typeName(int type) {
+   static const char *names[] = {"A", "B", "C", "D", "E"};
+   if (type >= 0 && type < 5) {
+      return names[type];
+   }
+   if (auto kernel = KernelRegistry::instance().find(static_cast<ComputationType>(type))) {
+      return kernel->typeName;
+   }
+   return std::to_string(type);
+}
+}
+
+EngineProfiler &EngineProfiler::instance() {
+   static EngineProfiler profiler;
+   return profiler;
+}
+
+void EngineProfiler::start(unsigned samplesPerSecond) {
+   std::lock_guard<std::mutex> lock(mutex);
+   if (running) {
+      return;
+   }
+   // The samples of the previous run are discarded: the buffers of the threads that left are freed, the others are
+   // kept since their thread still points to its own
+   buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const auto &buffer) { return !buffer->registered; }),
+                 buffers.end());
+   for (auto &buffer: buffers) {
+      buffer->count = 0;
+      buffer->dropped = 0;
+   }
+   frequency = samplesPerSecond == 0 ? DEFAULT_FREQUENCY : samplesPerSecond;
+   startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+   // backtrace loads what it needs on its first call, which must not happen in the signal handler
+   void *frames[2];
+   backtrace(frames, 2);
+   struct sigaction action{};
+   action.sa_handler = &EngineProfiler::onSignal;
+   action.sa_flags = SA_RESTART;
+   sigemptyset(&action.sa_mask);
+   sigaction(SIGPROF, &action, nullptr);
+   // The threads still registered since the previous run are sampled again
+   for (auto &buffer: buffers) {
+      armTimer(*buffer);
+   }
+   running = true;
+}
+
+void EngineProfiler::stop() {
+   std::lock_guard<std::mutex> lock(mutex);
+   running = false;
+   for (auto &buffer: buffers) {
+      disarmTimer(*buffer);
+   }
+}
+
+void EngineProfiler::registerCurrentThread(ComputationType type) {
+   std::lock_guard<std::mutex> lock(mutex);
+   if (!running || currentBuffer != nullptr) {
+      return;
+   }
+   buffers.push_back(std::make_unique<SampleBuffer>());
+   SampleBuffer *buffer = buffers.back().get();
+   buffer->type = static_cast<int>(type);
+   buffer->thread = static_cast<pid_t>(syscall(SYS_gettid));
+   pthread_getcpuclockid(pthread_self(), &buffer->clock);
+   buffer->registered = true;
+   // The thread locals are touched before the first signal, so that the handler does not allocate them
+   currentRequest = NO_REQUEST;
+   currentBuffer = buffer;
+   armTimer(*buffer);
+}
+
+void EngineProfiler::unregisterCurrentThread() {
+   std::lock_guard<std::mutex> lock(mutex);
+   if (currentBuffer != nullptr) {
+      disarmTimer(*currentBuffer);
+      // Its buffer is freed by the next start, its samples are kept until then
+      currentBuffer->registered = false;
+   }
+   currentBuffer = nullptr;
+}
+
+void EngineProfiler::armTimer(SampleBuffer &buffer) {
+   // The timer counts the CPU time of the thread only (its own clock, it may be armed by another thread) and sends the
+   // signal to it
+   struct sigevent event{};
+   event.sigev_notify = SIGEV_THREAD_ID;
+   event.sigev_signo = SIGPROF;
+   event.sigev_notify_thread_id = buffer.thread;
+   if (timer_create(buffer.clock, &event, &buffer.timer) != 0) {
+      return;
+   }
+   // The period is split, the nanoseconds must stay below a second
+   long period = 1000000000L / frequency;
+   struct itimerspec interval{};
+   interval.it_interval.tv_sec = period / 1000000000L;
+   interval.it_interval.tv_nsec = period % 1000000000L;
+   interval.it_value = interval.it_interval;
+   if (timer_settime(buffer.timer, 0, &interval, nullptr) != 0) {
+      timer_delete(buffer.timer);
+      return;
+   }
+   buffer.timerArmed = true;
+}
+
+void EngineProfiler::disarmTimer(SampleBuffer &buffer) {
+   if (buffer.timerArmed) {
+      timer_delete(buffer.timer);
+      buffer.timerArmed = false;
+   }
+}
+
+void EngineProfiler::onSignal(int) {
+   SampleBuffer *buffer = currentBuffer;
+   if (buffer == nullptr) {
+      return;
+   }
+   size_t index = buffer->count.load(std::memory_order_relaxed);
+   if (index >= SAMPLES_PER_THREAD) {
+      buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   Sample &sample = buffer->samples[index];
+   sample.depth = backtrace(sample.frames, MAX_FRAMES);
+   sample.type = buffer->type;
+   sample.request = currentRequest;
+   // The sample is published once it is complete
+   buffer->count.store(index + 1, std::memory_order_release);
+}
+
+size_t EngineProfiler::sampleCount() {
+   std::lock_guard<std::mutex> lock(mutex);
+   size_t count = 0;
+   for (auto &buffer: buffers) {
+      count += buffer->count.load(std::memory_order_acquire);
+   }
+   return count;
+}
+
+bool EngineProfiler::writeProfile(const std::string &path) {
+   std::lock_guard<std::mutex> lock(mutex);
+   StringTable strings;
+   ProtoWriter profile;
+   int64_t period = 1000000000L / frequency;
+
+   // The samples are counted and weighted by the CPU time they stand for
+   for (auto [type, unit]: {std::pair<const char *, const char *>{"samples", "count"}, {"cpu", "nanoseconds"}}) {
+      ProtoWriter valueType;
+      valueType.field(1, strings.index(type));
+      valueType.field(2, strings.index(unit));
+      profile.message(1, valueType);
+   }
+
+   // Identical samples (same stack, engine type and request) are merged
+   std::map<std::tuple<std::vector<uint64_t>, int, RequestId>, int64_t> merged;
+   std::map<uint64_t, uint64_t> locations;
+   for (auto &buffer: buffers) {
+      size_t count = buffer->count.load(std::memory_order_acquire);
+      for (size_t i = 0; i < count; ++i) {
+         const Sample &sample = buffer->samples[i];
+         std::vector<uint64_t> stack;
+         // The first frames are the ones of the signal handler
+         for (int frame = 2; frame < sample.depth; ++frame) {
+            auto address = reinterpret_cast<uint64_t>(sample.frames[frame]);
+            auto location = locations.emplace(address, locations.size() + 1).first;
+            stack.push_back(location->second);
+         }
+         ++merged[{stack, sample.type, sample.request}];
+      }
+   }
+   for (const auto &[key, count]: merged) {
+      ProtoWriter sample;
+      sample.packed(1, std::get<0>(key));
+      sample.packed(2, {static_cast<uint64_t>(count), static_cast<uint64_t>(count * period)});
+      ProtoWriter typeLabel;
+      typeLabel.field(1, strings.index("engine_type"));
+      typeLabel.field(2, strings.index(typeName(std::get<1>(key))));
+      sample.message(3, typeLabel);
+      if (std::get<2>(key) != NO_REQUEST) {
+         ProtoWriter requestLabel;
+         requestLabel.field(1, strings.index("request_id"));
+         requestLabel.field(3, std::get<2>(key));
+         sample.message(3, requestLabel);
+      }
+      profile.message(2, sample);
+   }
+
+   // The executable mappings let pprof symbolize the addresses with the binaries
+   struct Mapping {
+      uint64_t start;
+      uint64_t limit;
+      uint64_t id;
+   };
+   std::vector<Mapping> mappings;
+   std::ifstream maps("/proc/self/maps");
+   for (std::string line; std::getline(maps, line);) {
+      std::istringstream fields(line);
+      std::string range, permissions, offset, device, inode, file;
+      fields >> range >> permissions >> offset >> device >> inode >> file;
+      if (permissions.size() < 3 || permissions[2] != 'x' || file.empty() || file[0] != '/') {
+         continue;
+      }
+      auto dash = range.find('-');
+      Mapping mapping{std::stoull(range.substr(0, dash), nullptr, 16), std::stoull(range.substr(dash + 1), nullptr, 16),
+                      mappings.size() + 1};
+      ProtoWriter mappingMessage;
+      mappingMessage.field(1, mapping.id);
+      mappingMessage.field(2, mapping.start);
+      mappingMessage.field(3, mapping.limit);
+      mappingMessage.field(4, std::stoull(offset, nullptr, 16));
+      mappingMessage.field(5, strings.index(file));
+      profile.message(3, mappingMessage);
+      mappings.push_back(mapping);
+   }
+
+   // Every location gets the function (symbol) it belongs to, when there is one
+   std::map<std::string, uint64_t> functions;
+   for (const auto &[address, id]: locations) {
+      ProtoWriter location;
+      location.field(1, id);
+      for (const auto &mapping: mappings) {
+         if (address > mapping.start && address <= mapping.limit) {
+            location.field(2, mapping.id);
+            break;
+         }
+      }
+      // A return address points after the call
+      location.field(3, address - 1);
+      Dl_info info{};
+      if (dladdr(reinterpret_cast<void *>(address - 1), &info) && info.dli_sname) {
+         std::string name = info.dli_sname;
+         auto function = functions.find(name);
+         if (function == functions.end()) {
+            function = functions.emplace(name, functions.size() + 1).first;
+            ProtoWriter functionMessage;
+            functionMessage.field(1, function->second);
+            functionMessage.field(2, strings.index(name));
+            functionMessage.field(3, strings.index(name));
+            functionMessage.field(4, strings.index(info.dli_fname ? info.dli_fname : ""));
+            profile.message(5, functionMessage);
+         }
+         ProtoWriter line;
+         line.field(1, function->second);
+         location.message(4, line);
+      }
+      profile.message(4, location);
+   }
+
+   for (const auto &string: strings.strings) {
+      profile.field(6, string);
+   }
+   profile.field(9, static_cast<uint64_t>(startTime));
+   ProtoWriter periodType;
+   periodType.field(1, strings.index("cpu"));
+   periodType.field(2, strings.index("nanoseconds"));
+   // The strings of the period type are already in the table
+   profile.message(11, periodType);
+   profile.field(12, static_cast<uint64_t>(period));
+
+   std::ofstream file(path, std::ios::binary | std::ios::trunc);
+   file.write(profile.bytes.data(), static_cast<std::streamsize>(profile.bytes.size()));
+   return static_cast<bool>(file);
+}
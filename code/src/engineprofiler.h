@@ -0,0 +1,126 @@
+/**
+\file engineprofiler.h
+\author agent
+\date 19.10.2026
+
+Ce fichier contient la classe EngineProfiler, un profileur par échantillonnage intégré au processus. Chaque thread de
+moteur de calcul enregistré reçoit un signal selon le temps CPU qu'il consomme, sa pile est alors enregistrée (sans
+verrou) avec le type du moteur et l'id de la requête en cours. Le profil est écrit au format pprof.
+*/
+
+#ifndef ENGINEPROFILER_H
+#define ENGINEPROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "computationmanager.h"
+
+/**
+ * @brief The EngineProfiler class samples the stacks of the compute engine threads on their CPU time and writes
+ * pprof profiles (profile.proto, uncompressed)
+ */
+class EngineProfiler {
+public:
+   /**
+    * @brief instance Returns the profiler of the process
+    */
+   static EngineProfiler &instance();
+
+   /**
+    * @brief start Starts sampling the threads that register from now on
+    * @param frequency the number of samples per second of CPU time of a thread
+    */
+   void start(unsigned frequency = DEFAULT_FREQUENCY);
+
+   /**
+    * @brief stop Stops sampling (the samples are kept until the next start, which discards them and samples the
+    * threads still registered again)
+    */
+   void stop();
+
+   /**
+    * @brief isRunning Returns true if the profiler samples
+    */
+   [[nodiscard]] bool isRunning() const { return running; }
+
+   /**
+    * @brief registerCurrentThread Samples the calling thread, a compute engine of a given type, if the profiler runs
+    */
+   void registerCurrentThread(ComputationType type);
+
+   /**
+    * @brief unregisterCurrentThread Stops sampling the calling thread (its samples are kept)
+    */
+   void unregisterCurrentThread();
+
+   /**
+    * @brief setCurrentRequest Tags the next samples of the calling thread with a request id (NO_REQUEST for none)
+    */
+   static void setCurrentRequest(RequestId id) { currentRequest = id; }
+
+   /**
+    * @brief writeProfile Writes the samples taken since the start in a pprof file
+    * @return false if the file cannot be written
+    */
+   bool writeProfile(const std::string &path);
+
+   /**
+    * @brief sampleCount Returns the number of samples taken since the start
+    */
+   size_t sampleCount();
+
+   // The number of samples per second of CPU time by default
+   static constexpr unsigned DEFAULT_FREQUENCY = 100;
+   // The maximum depth of a recorded stack
+   static constexpr int MAX_FRAMES = 48;
+   // The number of samples a thread can record (the next ones are dropped)
+   static constexpr size_t SAMPLES_PER_THREAD = 8192;
+
+private:
+   EngineProfiler() = default;
+
+   struct Sample {
+      void *frames[MAX_FRAMES];
+      int depth;
+      int type;
+      RequestId request;
+   };
+
+   // Written by the signal handler of its thread only, read once the count is published
+   struct SampleBuffer {
+      std::unique_ptr<Sample[]> samples{new Sample[SAMPLES_PER_THREAD]};
+      std::atomic<size_t> count{0};
+      std::atomic<size_t> dropped{0};
+      int type{0};
+      timer_t timer{};
+      bool timerArmed{false};
+      // The kernel id and the CPU clock of the thread, and whether it is still registered (its timer is armed again by
+      // the next start)
+      pid_t thread{0};
+      clockid_t clock{CLOCK_THREAD_CPUTIME_ID};
+      bool registered{false};
+   };
+
+   static void onSignal(int signal);
+   // Arms or deletes the timer sampling the thread of a buffer (with the mutex)
+   void armTimer(SampleBuffer &buffer);
+   static void disarmTimer(SampleBuffer &buffer);
+
+   std::mutex mutex;
+   std::vector<std::unique_ptr<SampleBuffer>> buffers;
+   std::atomic<bool> running{false};
+   unsigned frequency{DEFAULT_FREQUENCY};
+   int64_t startTime{0};
+
+   static thread_local SampleBuffer *currentBuffer;
+   static thread_local RequestId currentRequest;
+};
+
+#endif // ENGINEPROFILER_H
@@ -0,0 +1,202 @@
+/**
+\file kernelcalibration.cpp
+\author agent
+\date 19.10.2026
+
+Ce fichier contient l'implémentation de la calibration des noyaux de réduction.
+*/
+
+#include "kernelcalibration.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+namespace {
+std::mutex configurationMutex;
+KernelConfiguration configuration;
+
+template<unsigned N, typename Operation>
+void reduceWith(double *acc, const double *chunk, size_t n, Operation op) {
+   // Independent accumulators, so that the operations can be vectorized
+   size_t i = 0;
+   for (; i + N <= n; i += N) {
+      for (unsigned j = 0; j < N; ++j) {
+         acc[j] = op(acc[j], chunk[i + j]);
+      }
+   }
+   for (; i < n; ++i) {
+      acc[0] = op(acc[0], chunk[i]);
+   }
+}
+
+template<typename Operation>
+void reduceWith(unsigned accumulators, double *acc, const double *chunk, size_t n, Operation op) {
+   switch (accumulators) {
+      case 1:
+         reduceWith<1>(acc, chunk, n, op);
+         break;
+      case 2:
+         reduceWith<2>(acc, chunk, n, op);
+         break;
+      case 8:
+         reduceWith<8>(acc, chunk, n, op);
+         break;
+      default:
+         reduceWith<4>(acc, chunk, n, op);
+         break;
+   }
+}
+
+std::string readFirstLine(const std::string &path) {
+   std::ifstream file(path);
+   std::string line;
+   std::getline(file, line);
+   return line;
+}
+}
+
+KernelConfiguration KernelCalibration::current() {
+   std::lock_guard<std::mutex> lock(configurationMutex);
+   return configuration;
+}
+
+void KernelCalibration::setCurrent(const KernelConfiguration &newConfiguration) {
+   std::lock_guard<std::mutex> lock(configurationMutex);
+   configuration = newConfiguration;
+}
+
+KernelConfiguration KernelCalibration::ensureCalibrated(const std::string &path) {
+   std::string file = path.empty() ? defaultCachePath() : path;
+   KernelConfiguration calibrated;
+   if (!load(file, calibrated)) {
+      calibrated = calibrate();
+      save(file, calibrated);
+   }
+   setCurrent(calibrated);
+   return calibrated;
+}
+
+KernelConfiguration KernelCalibration::calibrate() {
+   // A few MiB, more than the private caches, like the large requests
+   std::vector<double> data(1 << 19);
+   for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = 1.0 + static_cast<double>(i % 7) * 1e-9;
+   }
+   KernelConfiguration best;
+   double bestTime = 0.0;
+   volatile double sink = 0.0;
+   // Stands for the abort check made by the engines between two blocks
+   std::mutex abortCheck;
+   for (unsigned accumulators: {1u, 2u, 4u, 8u}) {
+      for (size_t blockSize: {1024ul, 4096ul, 16384ul, 65536ul}) {
+         // The best of a few runs, the first one warms the caches up
+         double time = 0.0;
+         for (int run = 0; run < 3; ++run) {
+            double acc[MAX_ACCUMULATORS] = {};
+            auto start = std::chrono::steady_clock::now();
+            for (size_t position = 0; position < data.size(); position += blockSize) {
+               { std::lock_guard<std::mutex> check(abortCheck); }
+               size_t n = std::min(blockSize, data.size() - position);
+               reduce(accumulators, acc, data.data() + position, n, false);
+            }
+            sink = sink + combine(accumulators, acc, false);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (run == 0 || elapsed.count() < time) {
+               time = elapsed.count();
+            }
+         }
+         if (bestTime == 0.0 || time < bestTime) {
+            bestTime = time;
+            best = {accumulators, blockSize};
+         }
+      }
+   }
+   return best;
+}
+
+bool KernelCalibration::load(const std::string &path, KernelConfiguration &loaded) {
+   std::ifstream file(path);
+   std::string signature;
+   if (!file || !std::getline(file, signature) || signature != hostSignature()) {
+      return false;
+   }
+   KernelConfiguration read;
+   if (!(file >> read.accumulators >> read.blockSize)) {
+      return false;
+   }
+   if (read.accumulators == 0 || read.accumulators > MAX_ACCUMULATORS ||
+       (read.accumulators & (read.accumulators - 1)) != 0 || read.blockSize == 0) {
+      return false;
+   }
+   loaded = read;
+   return true;
+}
+
+bool KernelCalibration::save(const std::string &path, const KernelConfiguration &saved) {
+   // The directory of the cache file is created if needed
+   auto slash = path.rfind('/');
+   if (slash != std::string::npos && slash > 0) {
+      std::string directory = path.substr(0, slash);
+      for (size_t next = directory.find('/', 1); ; next = directory.find('/', next + 1)) {
+         mkdir(directory.substr(0, next).c_str(), 0755);
+         if (next == std::string::npos) {
+            break;
+         }
+      }
+   }
+   std::ofstream file(path, std::ios::trunc);
+   file << hostSignature() << '\n' << saved.accumulators << ' ' << saved.blockSize << '\n';
+   return static_cast<bool>(file);
+}
+
+std::string KernelCalibration::defaultCachePath() {
+   if (const char *cache = std::getenv("XDG_CACHE_HOME")) {
+      return std::string(cache) + "/labo6/kernels.conf";
+   }
+   const char *home = std::getenv("HOME");
+   return std::string(home ? home : ".") + "/.cache/labo6/kernels.conf";
+}
+
+std::string KernelCalibration::hostSignature() {
+   std::string model;
+   std::ifstream cpuinfo("/proc/cpuinfo");
+   for (std::string line; std::getline(cpuinfo, line);) {
+      if (line.rfind("model name", 0) == 0) {
+         model = line.substr(line.find(':') + 1);
+         break;
+      }
+   }
+   std::ostringstream signature;
+   signature << "host" << model << " | cpus " << std::thread::hardware_concurrency();
+   for (int index = 0; index < 4; ++index) {
+      std::string size = readFirstLine("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/size");
+      if (!size.empty()) {
+         signature << " | " << size;
+      }
+   }
+   return signature.str();
+}
+
+void KernelCalibration::reduce(unsigned accumulators, double *acc, const double *chunk, size_t n, bool product) {
+   if (product) {
+      reduceWith(accumulators, acc, chunk, n, std::multiplies<>());
+   } else {
+      reduceWith(accumulators, acc, chunk, n, std::plus<>());
+   }
+}
+
+double KernelCalibration::combine(unsigned accumulators, const double *acc, bool product) {
+   double result = acc[0];
+   for (unsigned i = 1; i < accumulators; ++i) {
+      result = product ? result * acc[i] : result + acc[i];
+   }
+   return result;
+}
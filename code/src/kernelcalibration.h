@@ -0,0 +1,98 @@
+/**
+\file kernelcalibration.h
+\author agent
+\date 19.10.2026
+
+Ce fichier contient la classe KernelCalibration qui choisit, pour la machine courante, les paramètres des noyaux de
+réduction (nombre d'accumulateurs, taille des blocs) en mesurant plusieurs variantes au premier démarrage. La
+configuration retenue est enregistrée dans un fichier de cache local et simplement rechargée aux démarrages suivants.
+*/
+
+#ifndef KERNELCALIBRATION_H
+#define KERNELCALIBRATION_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief The KernelConfiguration struct holds the parameters of the reduction kernels
+ */
+struct KernelConfiguration {
+   // The number of independent accumulators (1, 2, 4 or 8), the vector width the compiler can use
+   unsigned accumulators{4};
+   // The number of elements reduced between two abort checks
+   size_t blockSize{4096};
+};
+
+/**
+ * @brief The KernelCalibration class gives the kernel configuration of the host, calibrated once and cached
+ */
+class KernelCalibration {
+public:
+   /**
+    * @brief current Returns the configuration used by the kernels (the default one until the host is calibrated)
+    */
+   static KernelConfiguration current();
+
+   /**
+    * @brief setCurrent Sets the configuration used by the kernels
+    */
+   static void setCurrent(const KernelConfiguration &configuration);
+
+   /**
+    * @brief ensureCalibrated Loads the configuration of the host from the cache file, or calibrates the host and
+    * writes the cache file if there isn't any valid one, then uses it
+    * @param path the cache file (defaultCachePath() if empty)
+    * @return the configuration
+    */
+   static KernelConfiguration ensureCalibrated(const std::string &path = "");
+
+   /**
+    * @brief calibrate Micro-benchmarks the kernel variants on the host and returns the fastest one
+    */
+   static KernelConfiguration calibrate();
+
+   /**
+    * @brief load Reads a cache file
+    * @param path the cache file
+    * @param configuration the configuration read
+    * @return false if the file does not exist, is not valid or was written for another host
+    */
+   static bool load(const std::string &path, KernelConfiguration &configuration);
+
+   /**
+    * @brief save Writes a cache file for the host
+    * @return false if the file cannot be written
+    */
+   static bool save(const std::string &path, const KernelConfiguration &configuration);
+
+   /**
+    * @brief defaultCachePath Returns $XDG_CACHE_HOME/labo6/kernels.conf (or ~/.cache/labo6/kernels.conf)
+    */
+   static std::string defaultCachePath();
+
+   /**
+    * @brief hostSignature Returns what identifies the host in a cache file (CPU model, number of CPUs, cache sizes)
+    */
+   static std::string hostSignature();
+
+   /**
+    * @brief reduce Reduces a chunk into accumulators with a given number of them
+    * @param accumulators the number of accumulators used (1, 2, 4 or 8)
+    * @param acc the accumulators (at least 8, initialized to the neutral element)
+    * @param chunk the elements
+    * @param n the number of elements
+    * @param product true to multiply, false to add
+    */
+   static void reduce(unsigned accumulators, double *acc, const double *chunk, size_t n, bool product);
+
+   /**
+    * @brief combine Combines the accumulators filled by reduce
+    */
+   static double combine(unsigned accumulators, const double *acc, bool product);
+
+   // The number of accumulators reduce can use at most
+   static constexpr unsigned MAX_ACCUMULATORS = 8;
+};
+
+#endif // KERNELCALIBRATION_H
@@ -0,0 +1,81 @@
+/**
+\file kernelplugin.h
+\author agent
+\date 18.10.2026
+
+Ce fichier contient l'ABI (interface binaire, en C) que doit respecter un greffon de calcul chargé dynamiquement
+(dlopen). Un greffon exporte une fonction d'entrée qui retourne la description de son noyau de calcul : le nom du
+type de calcul, la fonction qui traite un morceau des données, la taille de l'état et des indications sur son exécution.
+*/
+
+#ifndef KERNELPLUGIN_H
+#define KERNELPLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief LABO6_KERNEL_ABI_VERSION The version of the ABI below, a plugin built for another version is rejected
+ */
+#define LABO6_KERNEL_ABI_VERSION 1
+
+/**
+ * @brief LABO6_KERNEL_ENTRY_POINT The name of the symbol (of type Labo6KernelEntryPoint) a plugin must export
+ */
+#define LABO6_KERNEL_ENTRY_POINT "labo6_kernel_descriptor"
+
+/**
+ * @brief The Labo6KernelDescriptor struct describes a computation kernel provided by a plugin.
+ * The compute engine allocates stateSize bytes (max aligned) for every request, calls init once,
+ * then step for every chunk of consecutive elements of the data and finally finish to get the result.
+ * The functions must not keep pointers on the data after they return.
+ */
+typedef struct Labo6KernelDescriptor {
+   /**
+    * @brief abiVersion Must be LABO6_KERNEL_ABI_VERSION
+    */
+   uint32_t abiVersion;
+   /**
+    * @brief typeName The name of the computation type (e.g. "SumOfSquares"), must be unique
+    */
+   const char *typeName;
+   /**
+    * @brief stateSize The size in bytes of the state of a computation
+    */
+   size_t stateSize;
+   /**
+    * @brief chunkSize Hint, the number of elements to process between two abort checks (0 : everything at once)
+    */
+   size_t chunkSize;
+   /**
+    * @brief suggestedEngines Hint, the number of compute engines the environment should start for this kernel
+    */
+   unsigned suggestedEngines;
+   /**
+    * @brief init Initializes the state of a computation over size elements
+    */
+   void (*init)(void *state, size_t size);
+   /**
+    * @brief step Processes count consecutive elements
+    */
+   void (*step)(void *state, const double *chunk, size_t count);
+   /**
+    * @brief finish Returns the result of the computation
+    */
+   double (*finish)(const void *state);
+} Labo6KernelDescriptor;
+
+/**
+ * @brief Labo6KernelEntryPoint The type of the function exported by a plugin under LABO6_KERNEL_ENTRY_POINT
+ */
+typedef const Labo6KernelDescriptor *(*Labo6KernelEntryPoint)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KERNELPLUGIN_H
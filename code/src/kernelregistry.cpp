@@ -0,0 +1,114 @@
+/**
+\file kernelregistry.cpp
+\author agent
+\date 18.10.2026
+
+Ce fichier contient l'implémentation de la classe KernelRegistry qui charge les greffons de calcul.
+*/
+
+#include "kernelregistry.h"
+
+#include <cstdlib>
+#include <dlfcn.h>
+#include <sstream>
+
+KernelRegistry &KernelRegistry::instance() {
+   static KernelRegistry registry;
+   return registry;
+}
+
+ComputationType KernelRegistry::loadPlugin(const std::string &path) {
+   void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+   if (handle == nullptr) {
+      throw PluginException("Cannot load kernel plugin " + path + " : " + dlerror());
+   }
+
+   auto entryPoint = reinterpret_cast<Labo6KernelEntryPoint>(dlsym(handle, LABO6_KERNEL_ENTRY_POINT));
+   const Labo6KernelDescriptor *descriptor = entryPoint ? entryPoint() : nullptr;
+
+   // We check the descriptor before it can reach a compute engine
+   std::string error;
+   if (entryPoint == nullptr) {
+      error = "missing entry point " LABO6_KERNEL_ENTRY_POINT;
+   } else if (descriptor == nullptr) {
+      error = "no descriptor provided";
+   } else if (descriptor->abiVersion != LABO6_KERNEL_ABI_VERSION) {
+      error = "ABI version " + std::to_string(descriptor->abiVersion) + " instead of " +
+              std::to_string(LABO6_KERNEL_ABI_VERSION);
+   } else if (descriptor->typeName == nullptr || descriptor->typeName[0] == '\0') {
+      error = "no type name";
+   } else if (descriptor->init == nullptr || descriptor->step == nullptr || descriptor->finish == nullptr) {
+      error = "missing kernel function";
+   }
+   if (!error.empty()) {
+      dlclose(handle);
+      throw PluginException("Invalid kernel plugin " + path + " : " + error);
+   }
+
+   std::lock_guard<std::mutex> lock(mutex);
+   auto existing = typesByName.find(descriptor->typeName);
+   if (existing != typesByName.end()) {
+      // Loading the same plugin twice only bumps the reference count of the handle, another plugin cannot reuse the
+      // name (dlopen returns the same handle for the same shared object)
+      bool samePlugin = handles[existing->second] == handle;
+      dlclose(handle);
+      if (!samePlugin) {
+         throw PluginException("Invalid kernel plugin " + path + " : type name " + existing->first +
+                               " already registered by another plugin");
+      }
+      return existing->second;
+   }
+   auto type = static_cast<ComputationType>(FIRST_PLUGIN_TYPE + static_cast<int>(kernels.size()));
+   kernels[type] = descriptor;
+   typesByName.emplace(descriptor->typeName, type);
+   handles[type] = handle;
+   return type;
+}
+
+size_t KernelRegistry::loadFromEnvironment() {
+   const char *paths = std::getenv(PLUGIN_PATH_VARIABLE);
+   if (paths == nullptr) {
+      return 0;
+   }
+   size_t loaded = 0;
+   std::string failures;
+   std::istringstream stream(paths);
+   std::string path;
+   while (std::getline(stream, path, ':')) {
+      if (path.empty()) {
+         continue;
+      }
+      // A plugin that cannot be loaded does not prevent the next ones from being loaded
+      try {
+         loadPlugin(path);
+         ++loaded;
+      } catch (PluginException &e) {
+         failures += failures.empty() ? e.what() : std::string("\n") + e.what();
+      }
+   }
+   if (!failures.empty()) {
+      throw PluginException(failures);
+   }
+   return loaded;
+}
+
+const Labo6KernelDescriptor *KernelRegistry::find(ComputationType type) const {
+   std::lock_guard<std::mutex> lock(mutex);
+   auto it = kernels.find(type);
+   return it == kernels.end() ? nullptr : it->second;
+}
+
+ComputationType KernelRegistry::typeFromName(const std::string &typeName) const {
+   std::lock_guard<std::mutex> lock(mutex);
+   return typesByName.at(typeName);
+}
+
+std::vector<ComputationType> KernelRegistry::types() const {
+   std::lock_guard<std::mutex> lock(mutex);
+   std::vector<ComputationType> result;
+   result.reserve(kernels.size());
+   for (const auto &kernel: kernels) {
+      result.push_back(kernel.first);
+   }
+   return result;
+}
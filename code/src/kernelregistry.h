@@ -0,0 +1,102 @@
+/**
+\file kernelregistry.h
+\author agent
+\date 18.10.2026
+
+Ce fichier contient la définition de la classe KernelRegistry qui charge les greffons de calcul (dlopen) et leur
+attribue un type de calcul. L'environnement de calcul s'en sert pour lancer des moteurs pour ces nouveaux types.
+*/
+
+#ifndef KERNELREGISTRY_H
+#define KERNELREGISTRY_H
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "computationmanager.h"
+#include "kernelplugin.h"
+
+/**
+ * @brief The KernelRegistry class keeps the kernels loaded from plugins, each one with its own computation type.
+ * Plugins are expected to be loaded at startup, before the compute environment is populated.
+ */
+class KernelRegistry {
+public:
+   /**
+    * @brief The PluginException class is thrown when a plugin cannot be loaded
+    */
+   class PluginException : public std::runtime_error {
+   public:
+      using std::runtime_error::runtime_error;
+   };
+
+   /**
+    * @brief FIRST_PLUGIN_TYPE The value of the first computation type given to a plugin, the built-in types are below
+    */
+   static constexpr int FIRST_PLUGIN_TYPE = 64;
+
+   /**
+    * @brief PLUGIN_PATH_VARIABLE The environment variable listing the plugins to load, separated by ':'
+    */
+   static constexpr const char *PLUGIN_PATH_VARIABLE = "LABO6_KERNEL_PLUGINS";
+
+   /**
+    * @brief instance Returns the registry of the process
+    */
+   static KernelRegistry &instance();
+
+   /**
+    * @brief loadPlugin Loads a plugin and registers its kernel
+    * @param path the path of the shared object
+    * @return the computation type assigned to the kernel (the same one if the plugin is already loaded)
+    * @throw PluginException if the plugin cannot be loaded, its descriptor is invalid or another plugin already
+    * registered its type name
+    */
+   ComputationType loadPlugin(const std::string &path);
+
+   /**
+    * @brief loadFromEnvironment Loads every plugin listed in PLUGIN_PATH_VARIABLE, the plugins that cannot be
+    * loaded are skipped
+    * @return the number of plugins loaded
+    * @throw PluginException once the others are loaded if some plugins cannot be loaded, with one line per plugin
+    */
+   size_t loadFromEnvironment();
+
+   /**
+    * @brief find Returns the kernel of a computation type
+    * @param type the computation type
+    * @return the descriptor or nullptr if the type is not provided by a plugin
+    */
+   const Labo6KernelDescriptor *find(ComputationType type) const;
+
+   /**
+    * @brief typeFromName Looks up the computation type of a kernel by its name
+    * @param typeName the name given by the plugin
+    * @return the computation type
+    * @throw std::out_of_range if no kernel has this name
+    */
+   ComputationType typeFromName(const std::string &typeName) const;
+
+   /**
+    * @brief types Returns the computation types provided by plugins, in registration order
+    */
+   std::vector<ComputationType> types() const;
+
+private:
+   KernelRegistry() = default;
+
+   // Protects the maps below
+   mutable std::mutex mutex;
+   // The kernels indexed by their computation type
+   std::map<ComputationType, const Labo6KernelDescriptor *> kernels;
+   // The computation types indexed by their name
+   std::map<std::string, ComputationType> typesByName;
+   // The handles of the loaded plugins indexed by the type of their kernel, they are never closed since engines may
+   // use them until the end
+   std::map<ComputationType, void *> handles;
+};
+
+#endif // KERNELREGISTRY_H
@@ -0,0 +1,243 @@
+/**
+\file memoryresidency.cpp
+\author agent
+\date 19.10.2026
+
+Ce fichier contient l'implémentation de la politique de résidence mémoire.
+*/
+
+#include "memoryresidency.h"
+
+#include <algorithm>
+#include <alloca.h>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+std::atomic<ResidencyPolicy> MemoryResidency::currentPolicy{ResidencyPolicy::None};
+
+namespace {
+size_t pageSize() {
+   static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+   return size;
+}
+}
+
+bool MemoryResidency::apply(ResidencyPolicy policy) {
+   currentPolicy = policy;
+   if (policy == ResidencyPolicy::All) {
+      return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+   }
+   return true;
+}
+
+ResidencyPolicy MemoryResidency::policy() {
+   return currentPolicy;
+}
+
+ResidencyPolicy MemoryResidency::policyFromEnvironment(ResidencyPolicy fallback) {
+   const char *value = std::getenv("LABO6_MEMORY_RESIDENCY");
+   if (value == nullptr) {
+      return fallback;
+   }
+   std::string name(value);
+   if (name == "none") {
+      return ResidencyPolicy::None;
+   }
+   if (name == "targeted") {
+      return ResidencyPolicy::Targeted;
+   }
+   if (name == "all") {
+      return ResidencyPolicy::All;
+   }
+   return fallback;
+}
+
+bool MemoryResidency::lock(const void *address, size_t size) {
+   if (currentPolicy != ResidencyPolicy::Targeted || size == 0) {
+      return currentPolicy == ResidencyPolicy::All;
+   }
+   // mlock works on whole pages and faults them in
+   auto begin = reinterpret_cast<uintptr_t>(address) & ~(pageSize() - 1);
+   auto end = reinterpret_cast<uintptr_t>(address) + size;
+   return mlock(reinterpret_cast<void *>(begin), end - begin) == 0;
+}
+
+void MemoryResidency::lockStack(size_t size) {
+   if (currentPolicy != ResidencyPolicy::Targeted) {
+      return;
+   }
+   // The pages below the current frame are touched so that they exist before being locked
+   auto *stack = static_cast<volatile char *>(alloca(size));
+   for (size_t i = 0; i < size; i += pageSize()) {
+      stack[i] = 0;
+   }
+   lock(const_cast<char *>(stack), size);
+}
+
+void *MemoryResidency::mapRegion(size_t size) {
+   void *region = MAP_FAILED;
+#ifdef MAP_HUGETLB
+   // Explicit huge pages are only used if some are reserved on the system
+   if (size % HUGE_PAGE_SIZE == 0) {
+      region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+   }
+#endif
+   if (region == MAP_FAILED) {
+      // The transparent huge pages need a region aligned on them : a larger region is mapped and its ends trimmed
+      size_t alignment = size % HUGE_PAGE_SIZE == 0 ? HUGE_PAGE_SIZE : 0;
+      region = mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (region == MAP_FAILED) {
+         return nullptr;
+      }
+      if (alignment > 0) {
+         auto begin = reinterpret_cast<uintptr_t>(region);
+         auto aligned = (begin + alignment - 1) / alignment * alignment;
+         if (aligned > begin) {
+            munmap(region, aligned - begin);
+         }
+         if (aligned + size < begin + size + alignment) {
+            munmap(reinterpret_cast<void *>(aligned + size), begin + alignment - aligned);
+         }
+         region = reinterpret_cast<void *>(aligned);
+      }
+#ifdef MADV_HUGEPAGE
+      // Else transparent huge pages are asked for
+      madvise(region, size, MADV_HUGEPAGE);
+#endif
+   }
+   lock(region, size);
+   return region;
+}
+
+void MemoryResidency::unmapRegion(void *address, size_t size) {
+   if (address != nullptr) {
+      munmap(address, size);
+   }
+}
+
+thread_local NodePool::ThreadCaches NodePool::threadCaches;
+NodePool *NodePool::cachedPools[NodePool::MAX_CACHED_POOLS];
+std::atomic<size_t> NodePool::cachedPoolCount{0};
+
+NodePool::NodePool(size_t blockSize) : blockSize(std::max(blockSize, sizeof(FreeBlock))), index(cachedPoolCount++) {
+   if (index < MAX_CACHED_POOLS) {
+      cachedPools[index] = this;
+   }
+}
+
+NodePool::ThreadCaches::~ThreadCaches() {
+   for (size_t i = 0; i < MAX_CACHED_POOLS && i < cachedPoolCount; ++i) {
+      if (caches[i].count > 0) {
+         cachedPools[i]->release(caches[i], caches[i].count);
+      }
+   }
+}
+
+void *NodePool::take() {
+   if (index >= MAX_CACHED_POOLS) {
+      std::lock_guard<std::mutex> lock(mutex);
+      return takeShared();
+   }
+   auto &cache = threadCaches.caches[index];
+   if (cache.blocks == nullptr) {
+      refill(cache);
+   }
+   FreeBlock *block = cache.blocks;
+   cache.blocks = block->next;
+   --cache.count;
+   return block;
+}
+
+void NodePool::give(void *block) {
+   auto *freeBlock = static_cast<FreeBlock *>(block);
+   if (index >= MAX_CACHED_POOLS) {
+      std::lock_guard<std::mutex> lock(mutex);
+      freeBlock->next = freeBlocks;
+      freeBlocks = freeBlock;
+      return;
+   }
+   auto &cache = threadCaches.caches[index];
+   freeBlock->next = cache.blocks;
+   cache.blocks = freeBlock;
+   // A thread that frees the blocks taken by another one gives them back by batches
+   if (++cache.count >= 2 * CACHE_BATCH) {
+      release(cache, CACHE_BATCH);
+   }
+}
+
+void NodePool::refill(ThreadCache &cache) {
+   std::lock_guard<std::mutex> lock(mutex);
+   for (size_t i = 0; i < CACHE_BATCH; ++i) {
+      FreeBlock *block = takeShared();
+      block->next = cache.blocks;
+      cache.blocks = block;
+      ++cache.count;
+      // A new region is only mapped for an empty cache
+      if (freeBlocks == nullptr) {
+         break;
+      }
+   }
+}
+
+void NodePool::release(ThreadCache &cache, size_t count) {
+   std::lock_guard<std::mutex> lock(mutex);
+   for (; count > 0; --count) {
+      FreeBlock *block = cache.blocks;
+      cache.blocks = block->next;
+      --cache.count;
+      block->next = freeBlocks;
+      freeBlocks = block;
+   }
+}
+
+NodePool::FreeBlock *NodePool::takeShared() {
+   if (freeBlocks == nullptr) {
+      // A new region is cut into blocks
+      void *region = MemoryResidency::mapRegion(REGION_SIZE);
+      if (region == nullptr) {
+         throw std::bad_alloc();
+      }
+      regions.push_back(region);
+      auto *bytes = static_cast<char *>(region);
+      for (size_t offset = 0; offset + blockSize <= REGION_SIZE; offset += blockSize) {
+         auto *block = reinterpret_cast<FreeBlock *>(bytes + offset);
+         block->next = freeBlocks;
+         freeBlocks = block;
+      }
+   }
+   FreeBlock *block = freeBlocks;
+   freeBlocks = block->next;
+   return block;
+}
+
+PayloadArena::PayloadArena(size_t capacity) {
+   // The region is rounded up to whole huge pages if it is large enough to use some
+   size = capacity * sizeof(double);
+   size_t granularity = size >= MemoryResidency::HUGE_PAGE_SIZE ? MemoryResidency::HUGE_PAGE_SIZE : pageSize();
+   size = (size + granularity - 1) / granularity * granularity;
+   region = MemoryResidency::mapRegion(size);
+   if (region == nullptr) {
+      throw std::bad_alloc();
+   }
+}
+
+PayloadArena::~PayloadArena() {
+   MemoryResidency::unmapRegion(region, size);
+}
+
+double *PayloadArena::allocate(size_t count) {
+   size_t bytes = count * sizeof(double);
+   size_t offset = used.fetch_add(bytes);
+   if (offset + bytes > size) {
+      used.fetch_sub(bytes);
+      return nullptr;
+   }
+   return reinterpret_cast<double *>(static_cast<char *>(region) + offset);
+}
+
+void PayloadArena::reset() {
+   used = 0;
+}
@@ -0,0 +1,248 @@
+/**
+\file memoryresidency.h
+\author agent
+\date 19.10.2026
+
+Ce fichier contient la politique de résidence mémoire de l'application. Plutôt que de verrouiller toute la mémoire du
+processus (mlockall), seules les structures utilisées sur le chemin critique sont verrouillées et pré-chargées : le
+stockage des files et des résultats, les piles des moteurs de calcul et, optionnellement, une arène pour les données.
+*/
+
+#ifndef MEMORYRESIDENCY_H
+#define MEMORYRESIDENCY_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * @brief The ResidencyPolicy enum tells which memory is kept resident (locked and pre-faulted)
+ */
+enum class ResidencyPolicy {
+   // Nothing is locked
+   None,
+   // Only the hot structures are locked
+   Targeted,
+   // The whole process is locked (mlockall), current and future pages
+   All
+};
+
+/**
+ * @brief The MemoryResidency class applies the residency policy of the process
+ */
+class MemoryResidency {
+public:
+   /**
+    * @brief apply Applies a policy (to be called once at startup, before the hot structures are created)
+    * @param policy the policy
+    * @return false if the memory could not be locked (the policy is applied anyway)
+    */
+   static bool apply(ResidencyPolicy policy);
+
+   /**
+    * @brief policy Returns the current policy
+    */
+   static ResidencyPolicy policy();
+
+   /**
+    * @brief policyFromEnvironment Reads the policy from LABO6_MEMORY_RESIDENCY (none, targeted or all)
+    * @param fallback the policy used if the variable is not set or not valid
+    */
+   static ResidencyPolicy policyFromEnvironment(ResidencyPolicy fallback = ResidencyPolicy::Targeted);
+
+   /**
+    * @brief lock Locks and pre-faults a memory region if the policy is targeted
+    * @return true if the region is resident
+    */
+   static bool lock(const void *address, size_t size);
+
+   /**
+    * @brief lockStack Locks and pre-faults the stack of the calling thread below the current frame if the policy
+    * is targeted
+    * @param size the size of the stack to keep resident
+    */
+   static void lockStack(size_t size = STACK_RESIDENT_SIZE);
+
+   /**
+    * @brief mapRegion Maps an anonymous region, backed by huge pages where available (a multiple of the huge page
+    * size is aligned on them), locked if the policy is targeted
+    * @return the region or null
+    */
+   static void *mapRegion(size_t size);
+
+   /**
+    * @brief unmapRegion Unmaps a region returned by mapRegion
+    */
+   static void unmapRegion(void *address, size_t size);
+
+   // The size of the stack of a compute engine kept resident
+   static constexpr size_t STACK_RESIDENT_SIZE = 64 * 1024;
+   // The size of a huge page
+   static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+private:
+   static std::atomic<ResidencyPolicy> currentPolicy;
+};
+
+/**
+ * @brief The NodePool class gives fixed size blocks taken from resident regions. The blocks are never given back to
+ * the system : a freed block is reused by the next allocation, so the queues stop allocating once they reached their
+ * steady state size. The regions are huge pages (2 MB aligned) and every thread keeps a cache of free blocks, the
+ * shared list is only locked to move a batch of blocks.
+ */
+class NodePool {
+public:
+   /**
+    * @brief forBlock Returns the pool of the blocks of a given size (one pool per size)
+    */
+   template<size_t blockSize>
+   static NodePool &forBlock() {
+      static NodePool pool(blockSize);
+      return pool;
+   }
+
+   /**
+    * @brief take Returns a free block
+    */
+   void *take();
+
+   /**
+    * @brief give Gives a block back to the pool
+    */
+   void give(void *block);
+
+   NodePool(const NodePool &) = delete;
+   NodePool &operator=(const NodePool &) = delete;
+
+private:
+   explicit NodePool(size_t blockSize);
+
+   // The size of the regions the blocks are taken from
+   static constexpr size_t REGION_SIZE = MemoryResidency::HUGE_PAGE_SIZE;
+   // The number of blocks moved between the cache of a thread and the shared list
+   static constexpr size_t CACHE_BATCH = 32;
+   // The number of pools with thread caches (the others only use the shared list)
+   static constexpr size_t MAX_CACHED_POOLS = 8;
+
+   struct FreeBlock {
+      FreeBlock *next;
+   };
+
+   struct ThreadCache {
+      FreeBlock *blocks{nullptr};
+      size_t count{0};
+   };
+
+   // The caches of a thread, given back to their pools when the thread ends
+   struct ThreadCaches {
+      ThreadCache caches[MAX_CACHED_POOLS];
+      ~ThreadCaches();
+   };
+
+   /**
+    * @brief refill Moves a batch of blocks from the shared list to a cache, a new region is cut if there are none
+    */
+   void refill(ThreadCache &cache);
+
+   /**
+    * @brief release Moves blocks from a cache to the shared list
+    */
+   void release(ThreadCache &cache, size_t count);
+
+   // Takes a block from the shared list (with the mutex locked)
+   FreeBlock *takeShared();
+
+   static thread_local ThreadCaches threadCaches;
+   static NodePool *cachedPools[MAX_CACHED_POOLS];
+   static std::atomic<size_t> cachedPoolCount;
+
+   const size_t blockSize;
+   const size_t index;
+   std::mutex mutex;
+   FreeBlock *freeBlocks{nullptr};
+   std::vector<void *> regions;
+};
+
+/**
+ * @brief The PoolAllocator class is an allocator for the node based containers of the hot path (lists of requests
+ * and results), their nodes are taken from a NodePool
+ */
+template<typename T>
+class PoolAllocator {
+public:
+   using value_type = T;
+
+   PoolAllocator() noexcept = default;
+
+   template<typename U>
+   PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+   T *allocate(size_t n) {
+      // Only the nodes are pooled, the rare arrays come from the heap
+      if (n != 1) {
+         return static_cast<T *>(::operator new(n * sizeof(T)));
+      }
+      return static_cast<T *>(NodePool::forBlock<blockSize()>().take());
+   }
+
+   void deallocate(T *p, size_t n) noexcept {
+      if (n != 1) {
+         ::operator delete(p);
+         return;
+      }
+      NodePool::forBlock<blockSize()>().give(p);
+   }
+
+   template<typename U>
+   bool operator==(const PoolAllocator<U> &) const noexcept { return true; }
+
+   template<typename U>
+   bool operator!=(const PoolAllocator<U> &) const noexcept { return false; }
+
+private:
+   static constexpr size_t blockSize() {
+      constexpr size_t alignment = alignof(std::max_align_t);
+      return (sizeof(T) + alignment - 1) / alignment * alignment;
+   }
+};
+
+/**
+ * @brief The PayloadArena class is a resident region the data of the requests can be written to, to be given to a
+ * computation as segments (with the arena as owner)
+ */
+class PayloadArena {
+public:
+   /**
+    * @brief PayloadArena Maps the region of the arena
+    * @param capacity the number of values of the arena
+    */
+   explicit PayloadArena(size_t capacity);
+
+   ~PayloadArena();
+
+   PayloadArena(const PayloadArena &) = delete;
+   PayloadArena &operator=(const PayloadArena &) = delete;
+
+   /**
+    * @brief allocate Takes values from the arena
+    * @param count the number of values
+    * @return the values or null if the arena is full
+    */
+   double *allocate(size_t count);
+
+   /**
+    * @brief reset Makes the whole arena available again (the values given before must not be used anymore)
+    */
+   void reset();
+
+   [[nodiscard]] size_t capacity() const { return size / sizeof(double); }
+
+private:
+   void *region;
+   size_t size;
+   std::atomic<size_t> used{0};
+};
+
+#endif // MEMORYRESIDENCY_H
@@ -0,0 +1,90 @@
+/**
+\file packedintegers.cpp
+\author agent
+\date 19.10.2026
+
+Ce fichier contient l'implémentation de l'encodage et du décodage des entiers compressés.
+*/
+
+#include "packedintegers.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+std::shared_ptr<const PackedIntegers> PackedIntegers::encode(const int64_t *values, size_t count) {
+   auto packed = std::make_shared<PackedIntegers>();
+   packed->count = count;
+   uint64_t zigzag[BLOCK_SIZE];
+   for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+      size_t n = count - start < BLOCK_SIZE ? count - start : BLOCK_SIZE;
+      // The deltas are computed modulo 2^64 and zigzag encoded, so that small negative ones stay small
+      uint64_t all = 0;
+      for (size_t k = 1; k < n; ++k) {
+         uint64_t delta = static_cast<uint64_t>(values[start + k]) - static_cast<uint64_t>(values[start + k - 1]);
+         zigzag[k - 1] = (delta << 1) ^ (0 - (delta >> 63));
+         all |= zigzag[k - 1];
+      }
+      unsigned width = 0;
+      while (width < 64 && (all >> width) != 0) {
+         ++width;
+      }
+      packed->blocks.push_back({values[start], packed->words.size(), width});
+      size_t firstWord = packed->words.size();
+      // A delta is read from its word and the next one : a block whose deltas are all zero (width 0) still has a
+      // word before its padding word
+      size_t deltaWords = std::max<size_t>(1, ((n - 1) * width + 63) / 64);
+      packed->words.resize(firstWord + deltaWords + 1, 0);
+      for (size_t k = 0; k + 1 < n; ++k) {
+         size_t bit = k * width;
+         size_t shift = bit & 63;
+         packed->words[firstWord + bit / 64] |= zigzag[k] << shift;
+         if (shift + width > 64) {
+            packed->words[firstWord + bit / 64 + 1] |= zigzag[k] >> (64 - shift);
+         }
+      }
+   }
+   return packed;
+}
+
+void PackedIntegers::unpackDeltas(const Block &block, size_t n, int64_t *deltas) const {
+   const uint64_t *packed = words.data() + block.offset;
+   uint64_t mask = block.width == 64 ? ~0ULL : (1ULL << block.width) - 1;
+   // No branch in the loop, so that the compiler can vectorize it : a delta is read from two consecutive words, the
+   // double shift giving 0 when the delta does not cross them
+   for (size_t k = 0; k < n; ++k) {
+      size_t bit = k * block.width;
+      size_t shift = bit & 63;
+      uint64_t low = packed[bit / 64] >> shift;
+      uint64_t high = (packed[bit / 64 + 1] << 1) << (63 - shift);
+      uint64_t zigzag = (low | high) & mask;
+      deltas[k] = static_cast<int64_t>((zigzag >> 1) ^ (0 - (zigzag & 1)));
+   }
+}
+
+void PackedIntegers::decodeBlock(size_t block, double *out) const {
+   size_t n = blockLength(block);
+   int64_t deltas[BLOCK_SIZE];
+   unpackDeltas(blocks[block], n - 1, deltas);
+   // The running value wraps around like the deltas
+   uint64_t value = static_cast<uint64_t>(blocks[block].first);
+   out[0] = static_cast<double>(blocks[block].first);
+   for (size_t k = 1; k < n; ++k) {
+      value += static_cast<uint64_t>(deltas[k - 1]);
+      out[k] = static_cast<double>(static_cast<int64_t>(value));
+   }
+}
+
+int64_t PackedIntegers::at(size_t index) const {
+   if (index >= count) {
+      throw std::out_of_range("PackedIntegers::at");
+   }
+   const Block &block = blocks[index / BLOCK_SIZE];
+   size_t n = index % BLOCK_SIZE;
+   int64_t deltas[BLOCK_SIZE];
+   unpackDeltas(block, n, deltas);
+   uint64_t value = static_cast<uint64_t>(block.first);
+   for (size_t k = 0; k < n; ++k) {
+      value += static_cast<uint64_t>(deltas[k]);
+   }
+   return static_cast<int64_t>(value);
+}
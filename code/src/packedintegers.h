@@ -0,0 +1,99 @@
+/**
+\file packedintegers.h
+\author agent
+\date 19.10.2026
+
+Ce fichier contient la classe PackedIntegers, un encodage compressé de suites d'entiers (des compteurs par exemple).
+Les valeurs sont découpées en blocs, chaque bloc garde sa première valeur puis les différences successives, encodées
+en zigzag et empaquetées sur le nombre de bits nécessaire au bloc. Les moteurs de calcul décodent un bloc à la fois
+directement avant de le réduire, les données ne sont donc jamais décompressées en entier.
+*/
+
+#ifndef PACKEDINTEGERS_H
+#define PACKEDINTEGERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The PackedIntegers class holds integers compressed with delta and bit-packing, decoded block by block
+ */
+class PackedIntegers {
+public:
+   /**
+    * @brief encode Compresses integers
+    * @param values the integers
+    * @param count the number of integers
+    * @return the immutable compressed integers
+    */
+   static std::shared_ptr<const PackedIntegers> encode(const int64_t *values, size_t count);
+
+   static std::shared_ptr<const PackedIntegers> encode(const std::vector<int64_t> &values) {
+      return encode(values.data(), values.size());
+   }
+
+   /**
+    * @brief size Returns the number of integers
+    */
+   [[nodiscard]] size_t size() const { return count; }
+
+   /**
+    * @brief blockCount Returns the number of blocks
+    */
+   [[nodiscard]] size_t blockCount() const { return blocks.size(); }
+
+   /**
+    * @brief blockLength Returns the number of integers of a block (BLOCK_SIZE except for the last one)
+    */
+   [[nodiscard]] size_t blockLength(size_t block) const {
+      return block + 1 < blocks.size() ? BLOCK_SIZE : count - block * BLOCK_SIZE;
+   }
+
+   /**
+    * @brief compressedBytes Returns the memory used by the compressed integers
+    */
+   [[nodiscard]] size_t compressedBytes() const {
+      return sizeof(*this) + blocks.size() * sizeof(Block) + words.size() * sizeof(uint64_t);
+   }
+
+   /**
+    * @brief decodeBlock Decodes a block as doubles
+    * @param block the index of the block
+    * @param out at least blockLength(block) doubles
+    */
+   void decodeBlock(size_t block, double *out) const;
+
+   /**
+    * @brief at Returns an integer (decodes the beginning of its block)
+    */
+   [[nodiscard]] int64_t at(size_t index) const;
+
+   // The number of integers of a block
+   static constexpr size_t BLOCK_SIZE = 128;
+
+private:
+   struct Block {
+      // The first integer of the block, the deltas of the next ones follow
+      int64_t first;
+      // The index of the first word of the packed deltas and their number of bits
+      size_t offset;
+      unsigned width;
+   };
+
+   /**
+    * @brief unpackDeltas Unpacks the deltas of a block
+    * @param block the block
+    * @param n the number of deltas
+    * @param deltas the deltas unpacked
+    */
+   void unpackDeltas(const Block &block, size_t n, int64_t *deltas) const;
+
+   std::vector<Block> blocks;
+   // Every block is followed by a padding word, so that a delta can always be read from two consecutive words
+   std::vector<uint64_t> words;
+   size_t count{0};
+};
+
+#endif // PACKEDINTEGERS_H
@@ -0,0 +1,160 @@
+/**
+\file payload.cpp
+\author agent
+\date 18.10.2026
+
+Ce fichier contient l'implémentation de la classe Payload.
+*/
+
+#include "payload.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+Payload::Payload(std::shared_ptr<const std::vector<double>> vector) : vector(std::move(vector)) {
+   owner = this->vector;
+}
+
+Payload::Payload(const std::vector<DataSegment> &segments, std::shared_ptr<const void> owner) : owner(std::move(owner)) {
+   std::vector<DataSegment> nonEmpty;
+   for (const auto &segment: segments) {
+      if (segment.size > 0) {
+         nonEmpty.push_back(segment);
+         totalSize += segment.size;
+      }
+   }
+   if (nonEmpty.size() == 1) {
+      single = nonEmpty.front();
+   } else if (nonEmpty.size() > 1) {
+      several = std::make_shared<const std::vector<DataSegment>>(std::move(nonEmpty));
+   }
+}
+
+Payload::Payload(const Generator &generator, std::shared_ptr<const void> owner) : owner(std::move(owner)),
+                                                                                  generator(generator), generated(true),
+                                                                                  totalSize(generator.size()) {
+}
+
+Payload::Payload(std::shared_ptr<const PackedIntegers> packed) : packed(std::move(packed)) {
+   totalSize = this->packed ? this->packed->size() : 0;
+}
+
+double Payload::at(size_t index) const {
+   if (generated) {
+      if (index >= totalSize) {
+         throw std::out_of_range("Payload::at");
+      }
+      return generator(index);
+   }
+   if (packed) {
+      return static_cast<double>(packed->at(index));
+   }
+   for (const auto &segment: getSegments()) {
+      if (index < segment.size) {
+         return segment.data[index];
+      }
+      index -= segment.size;
+   }
+   throw std::out_of_range("Payload::at");
+}
+
+size_t Payload::hash() const {
+   // FNV-1a on the bits of every element, so that the split in segments does not matter
+   uint64_t h = 0xcbf29ce484222325ULL;
+   forEachChunk(0, size(), [&](const double *chunk, size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+         uint64_t bits;
+         std::memcpy(&bits, chunk + i, sizeof(bits));
+         h = (h ^ bits) * 0x100000001b3ULL;
+      }
+   });
+   return static_cast<size_t>(h ^ size());
+}
+
+bool Payload::sameContent(const Payload &other) const {
+   if (size() != other.size()) {
+      return false;
+   }
+   if (sameBuffer(other)) {
+      return true;
+   }
+   // A generated or compressed payload is compared chunk by chunk with the same range of the other one
+   if (generated || other.generated || packed || other.packed) {
+      size_t position = 0;
+      bool same = true;
+      forEachChunk(0, size(), [&](const double *chunk, size_t count) {
+         other.forEachChunk(position, position + count, [&](const double *otherChunk, size_t otherCount) {
+            same = same && std::memcmp(chunk, otherChunk, otherCount * sizeof(double)) == 0;
+            chunk += otherCount;
+         });
+         position += count;
+      });
+      return same;
+   }
+   // The segments of both payloads are walked side by side
+   auto segments = getSegments();
+   size_t index = 0, offset = 0;
+   for (const auto &segment: other.getSegments()) {
+      size_t done = 0;
+      while (done < segment.size) {
+         size_t count = std::min(segment.size - done, segments[index].size - offset);
+         if (std::memcmp(segment.data + done, segments[index].data + offset, count * sizeof(double)) != 0) {
+            return false;
+         }
+         done += count;
+         offset += count;
+         if (offset == segments[index].size) {
+            ++index;
+            offset = 0;
+         }
+      }
+   }
+   return true;
+}
+
+bool Payload::sameBuffer(const Payload &other) const {
+   if (generated || other.generated) {
+      return generated && other.generated && generator == other.generator;
+   }
+   if (packed || other.packed) {
+      return packed == other.packed;
+   }
+   auto segments = getSegments();
+   auto otherSegments = other.getSegments();
+   if (segments.size() != otherSegments.size()) {
+      return false;
+   }
+   for (size_t i = 0; i < segments.size(); ++i) {
+      if (segments[i].data != otherSegments[i].data || segments[i].size != otherSegments[i].size) {
+         return false;
+      }
+   }
+   return true;
+}
+
+std::optional<double> Generator::closedFormSum() const {
+   if (base) {
+      return std::nullopt;
+   }
+   // Sum of an arithmetic progression
+   auto n = static_cast<double>(count);
+   return n * start + step * n * (n - 1.0) / 2.0;
+}
+
+std::optional<double> Generator::closedFormProduct() const {
+   if (base) {
+      return std::nullopt;
+   }
+   if (step == 0.0) {
+      return std::pow(start, static_cast<double>(count));
+   }
+   // The product is zero if the range goes through zero
+   double zeroIndex = -start / step;
+   if (zeroIndex >= 0.0 && zeroIndex < static_cast<double>(count) && zeroIndex == std::floor(zeroIndex)) {
+      return 0.0;
+   }
+   return std::nullopt;
+}
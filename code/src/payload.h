@@ -0,0 +1,287 @@
+/**
+\file payload.h
+\author agent
+\date 18.10.2026
+
+Ce fichier contient la définition de la classe Payload qui représente les données d'un calcul sous la forme d'une
+liste de segments (pointeur, longueur) non contigus. Les moteurs de calcul parcourent directement les segments, ce
+qui évite au client de concaténer ses tableaux dans un seul std::vector<double>. Les données peuvent aussi être
+générées à la volée ou des entiers compressés, décodés par blocs.
+*/
+
+#ifndef PAYLOAD_H
+#define PAYLOAD_H
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "packedintegers.h"
+
+/**
+ * @brief The DataSegment struct references size consecutive doubles that are not owned by the segment
+ */
+struct DataSegment {
+   const double *data;
+   size_t size;
+};
+
+/**
+ * @brief The Generator class describes data computed on the fly instead of being stored : an affine range
+ * start + step * i (iota and constant ranges being special cases) or a strided view base[i * stride] on memory that
+ * is not owned by the generator
+ */
+class Generator {
+public:
+   Generator() = default;
+
+   /**
+    * @brief iota Returns the range start, start + 1, ..., start + count - 1
+    */
+   static Generator iota(size_t count, double start = 0.0) { return affine(count, start, 1.0); }
+
+   /**
+    * @brief constant Returns count times the same value
+    */
+   static Generator constant(size_t count, double value) { return affine(count, value, 0.0); }
+
+   /**
+    * @brief affine Returns the range start + step * i for i in [0, count)
+    */
+   static Generator affine(size_t count, double start, double step) {
+      Generator generator;
+      generator.count = count;
+      generator.start = start;
+      generator.step = step;
+      return generator;
+   }
+
+   /**
+    * @brief strided Returns the view base[0], base[stride], ..., base[(count - 1) * stride]
+    */
+   static Generator strided(const double *base, size_t count, size_t stride) {
+      Generator generator;
+      generator.count = count;
+      generator.base = base;
+      generator.stride = stride;
+      return generator;
+   }
+
+   /**
+    * @brief operator () Returns an element
+    */
+   double operator()(size_t index) const {
+      return base ? base[index * stride] : start + step * static_cast<double>(index);
+   }
+
+   [[nodiscard]] size_t size() const { return count; }
+
+   /**
+    * @brief closedFormSum Returns the sum of the elements if it can be computed without walking them
+    */
+   [[nodiscard]] std::optional<double> closedFormSum() const;
+
+   /**
+    * @brief closedFormProduct Returns the product of the elements if it can be computed without walking them
+    */
+   [[nodiscard]] std::optional<double> closedFormProduct() const;
+
+   /**
+    * @brief operator == Returns true if both generators describe the same range in the same way
+    */
+   bool operator==(const Generator &other) const {
+      return count == other.count && start == other.start && step == other.step && base == other.base &&
+             stride == other.stride;
+   }
+
+private:
+   size_t count{0};
+   double start{0.0};
+   double step{0.0};
+   const double *base{nullptr};
+   size_t stride{1};
+};
+
+/**
+ * @brief The SegmentView class is a read-only range over the segments of a payload
+ */
+class SegmentView {
+public:
+   SegmentView(const DataSegment *first, size_t count) : first(first), count(count) {}
+
+   /**
+    * @brief SegmentView Constructs a view on a single segment, held by the view
+    */
+   explicit SegmentView(DataSegment segment) : single(segment), count(segment.size > 0 ? 1 : 0) {}
+
+   [[nodiscard]] const DataSegment *begin() const { return first ? first : &single; }
+
+   [[nodiscard]] const DataSegment *end() const { return begin() + count; }
+
+   [[nodiscard]] size_t size() const { return count; }
+
+   [[nodiscard]] bool empty() const { return count == 0; }
+
+   const DataSegment &operator[](size_t index) const { return begin()[index]; }
+
+private:
+   DataSegment single{nullptr, 0};
+   const DataSegment *first{nullptr};
+   size_t count;
+};
+
+/**
+ * @brief The Payload class is a read-only view on the data of a computation made of one or several segments.
+ * It keeps alive the owner of the segments (if any) until the last copy of the payload is destroyed.
+ */
+class Payload {
+public:
+   Payload() = default;
+
+   /**
+    * @brief Payload Constructs a payload with a single segment covering a vector
+    * @param vector the data, kept alive by the payload. Its elements and its size are read when the payload is
+    * used, not when it is constructed : the vector may be changed until the computation executes.
+    */
+   explicit Payload(std::shared_ptr<const std::vector<double>> vector);
+
+   /**
+    * @brief Payload Constructs a payload from segments
+    * @param segments the segments in order, the empty ones are dropped
+    * @param owner the object owning the memory of the segments (can be null if the client keeps it alive)
+    */
+   Payload(const std::vector<DataSegment> &segments, std::shared_ptr<const void> owner);
+
+   /**
+    * @brief Payload Constructs a payload whose elements are generated on the fly
+    * @param generator the description of the elements
+    * @param owner the object owning the memory of a strided view (can be null)
+    */
+   explicit Payload(const Generator &generator, std::shared_ptr<const void> owner = nullptr);
+
+   /**
+    * @brief Payload Constructs a payload whose elements are compressed integers, decoded block by block
+    * @param packed the compressed integers, kept alive by the payload
+    */
+   explicit Payload(std::shared_ptr<const PackedIntegers> packed);
+
+   /**
+    * @brief getGenerator Returns the generator of the elements, or null if they are stored in segments
+    */
+   [[nodiscard]] const Generator *getGenerator() const { return generated ? &generator : nullptr; }
+
+   /**
+    * @brief getPacked Returns the compressed integers, or null if the elements are not compressed
+    */
+   [[nodiscard]] const std::shared_ptr<const PackedIntegers> &getPacked() const { return packed; }
+
+   /**
+    * @brief getOwner Returns the object owning the memory of the segments (can be null)
+    */
+   [[nodiscard]] const std::shared_ptr<const void> &getOwner() const { return owner; }
+
+   /**
+    * @brief size Returns the total number of elements
+    */
+   [[nodiscard]] size_t size() const { return vector ? vector->size() : totalSize; }
+
+   /**
+    * @brief getSegments Returns the non empty segments in order (none if the elements are generated or compressed)
+    */
+   [[nodiscard]] SegmentView getSegments() const {
+      if (vector) {
+         return SegmentView(DataSegment{vector->data(), vector->size()});
+      }
+      return several ? SegmentView(several->data(), several->size()) : SegmentView(&single, single.size > 0 ? 1 : 0);
+   }
+
+   /**
+    * @brief at Returns an element, the segments being seen as a single array
+    * @param index the index of the element
+    * @throw std::out_of_range if index >= size()
+    */
+   [[nodiscard]] double at(size_t index) const;
+
+   /**
+    * @brief forEachChunk Calls f(const double* chunk, size_t count) on the contiguous pieces covering [begin, end)
+    * @param begin the index of the first element
+    * @param end the index after the last element
+    * @param f the function to call on every piece, in order
+    */
+   template<typename F>
+   void forEachChunk(size_t begin, size_t end, F &&f) const {
+      if (generated) {
+         // The generated elements are evaluated by small chunks on the stack
+         double chunk[GENERATED_CHUNK_SIZE];
+         end = end < totalSize ? end : totalSize;
+         for (size_t position = begin; position < end; position += GENERATED_CHUNK_SIZE) {
+            size_t count = end - position < GENERATED_CHUNK_SIZE ? end - position : GENERATED_CHUNK_SIZE;
+            for (size_t i = 0; i < count; ++i) {
+               chunk[i] = generator(position + i);
+            }
+            f(static_cast<const double *>(chunk), count);
+         }
+         return;
+      }
+      if (packed) {
+         // The blocks covering the range are decoded one at a time on the stack
+         double chunk[PackedIntegers::BLOCK_SIZE];
+         end = end < totalSize ? end : totalSize;
+         for (size_t block = begin / PackedIntegers::BLOCK_SIZE; block * PackedIntegers::BLOCK_SIZE < end; ++block) {
+            size_t blockBegin = block * PackedIntegers::BLOCK_SIZE;
+            size_t from = begin > blockBegin ? begin - blockBegin : 0;
+            size_t to = (end - blockBegin < PackedIntegers::BLOCK_SIZE ? end - blockBegin : PackedIntegers::BLOCK_SIZE);
+            packed->decodeBlock(block, chunk);
+            f(static_cast<const double *>(chunk + from), to - from);
+         }
+         return;
+      }
+      size_t offset = 0;
+      for (const auto &segment: getSegments()) {
+         if (offset >= end) {
+            break;
+         }
+         size_t segmentEnd = offset + segment.size;
+         if (segmentEnd > begin) {
+            size_t from = begin > offset ? begin - offset : 0;
+            size_t to = (end < segmentEnd ? end : segmentEnd) - offset;
+            f(segment.data + from, to - from);
+         }
+         offset = segmentEnd;
+      }
+   }
+
+   /**
+    * @brief hash Returns a hash of the elements that does not depend on how they are split in segments
+    */
+   [[nodiscard]] size_t hash() const;
+
+   /**
+    * @brief sameContent Returns true if both payloads have exactly the same elements (bit for bit)
+    */
+   [[nodiscard]] bool sameContent(const Payload &other) const;
+
+   /**
+    * @brief sameBuffer Returns true if both payloads reference the same memory
+    */
+   [[nodiscard]] bool sameBuffer(const Payload &other) const;
+
+   // The number of generated elements given at once by forEachChunk
+   static constexpr size_t GENERATED_CHUNK_SIZE = 256;
+
+private:
+   // A single segment is stored inline and several ones are shared between the copies, so that copying a payload
+   // never allocates
+   DataSegment single{nullptr, 0};
+   std::shared_ptr<const std::vector<DataSegment>> several;
+   // A vector is read through its pointer when the payload is used
+   std::shared_ptr<const std::vector<double>> vector;
+   std::shared_ptr<const void> owner;
+   Generator generator;
+   bool generated{false};
+   std::shared_ptr<const PackedIntegers> packed;
+   size_t totalSize{0};
+};
+
+#endif // PAYLOAD_H